@@ -0,0 +1,132 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "order_book.hpp"
+
+/*
+ * L2 book update / query cost across many pairs, and checksum validation
+ * against recorded Kraken WS book messages.
+ *
+ *   ./order_book_bench [pairs] [depth]
+ *   ./order_book_bench --replay asset_pairs.json messages.jsonl [depth]
+ *
+ * messages.jsonl holds one WS v1 or v2 message per line, exactly as
+ * received. Every checksum in it must match.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+static double ns_since(bench_clock::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count() / static_cast<double>(ops);
+}
+
+static void report(const char* name, double ns) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(1) << std::setw(8) << ns << " ns/op" << std::endl;
+}
+
+static int replay(const std::string& asset_pairs, const std::string& messages, size_t depth) {
+    InstrumentRegistry instruments;
+    if (!instruments.load_from_file(asset_pairs)) return 1;
+    std::ifstream in(messages);
+    if (!in.good()) {
+        std::cerr << "Cannot open " << messages << std::endl;
+        return 1;
+    }
+
+    OrderBookSet books(instruments.size(), depth);
+    auto track = [&](const std::string& name) {
+        if (books.find(name)) return;
+        if (const InstrumentSpec* spec = instruments.find(name)) books.add_alias(name, books.slot_for(*spec));
+    };
+
+    uint64_t lines = 0, rejected = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        json message = json::parse(line);
+        if (message.is_array() && !message.empty() && message.back().is_string()) {
+            track(message.back().get<std::string>());
+        } else if (message.is_object() && message.contains("data")) {
+            for (const auto& entry : message["data"]) {
+                if (entry.contains("symbol")) track(entry["symbol"].get<std::string>());
+            }
+        }
+        if (!books.apply_ws_message(message)) {
+            rejected++;
+            std::cout << "  ❌ Line " << lines + 1 << " rejected" << std::endl;
+        }
+        lines++;
+    }
+
+    std::cout << "\n📚 Replayed " << lines << " messages: " << books.checksum_failures()
+              << " checksum failures, " << rejected << " rejected" << std::endl;
+    return rejected == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3 && std::string(argv[1]) == "--replay") {
+        return replay(argv[2], argv[3], argc > 4 ? std::stoul(argv[4]) : 1000);
+    }
+
+    size_t pairs = argc > 1 ? std::stoul(argv[1]) : 500;
+    size_t depth = argc > 2 ? std::stoul(argv[2]) : 100;
+
+    std::vector<InstrumentSpec> specs(pairs);
+    OrderBookSet books(pairs, depth);
+    std::mt19937_64 rng(7);
+    std::vector<int64_t> mid(pairs);
+    for (size_t p = 0; p < pairs; p++) {
+        specs[p].pair = "PAIR" + std::to_string(p);
+        specs[p].pair_decimals = 2;
+        specs[p].lot_decimals = 8;
+        auto slot = books.slot_for(specs[p]);
+        mid[p] = 100000 + static_cast<int64_t>(rng() % 5000000);
+        for (size_t i = 1; i <= depth; i++) {
+            books.set_level(slot, Side::Buy, Price{mid[p] - static_cast<int64_t>(i)}, Qty{static_cast<int64_t>(1 + rng() % 100000000)});
+            books.set_level(slot, Side::Sell, Price{mid[p] + static_cast<int64_t>(i)}, Qty{static_cast<int64_t>(1 + rng() % 100000000)});
+        }
+    }
+
+    // Updates cluster at the top: distance from mid is geometric
+    size_t updates = 1u << 22;
+    std::geometric_distribution<int> distance(0.15);
+    struct Update { uint32_t slot; Side side; Price price; Qty qty; };
+    std::vector<Update> stream(updates);
+    for (auto& u : stream) {
+        u.slot = static_cast<uint32_t>(rng() % pairs);
+        u.side = rng() & 1 ? Side::Buy : Side::Sell;
+        int64_t d = 1 + distance(rng);
+        u.price = Price{u.side == Side::Buy ? mid[u.slot] - d : mid[u.slot] + d};
+        u.qty = Qty{rng() % 4 == 0 ? 0 : static_cast<int64_t>(1 + rng() % 100000000)};
+    }
+
+    std::cout << "\n⏱️  ORDER BOOK BENCHMARK (" << pairs << " pairs x depth " << depth << ", "
+              << books.memory_bytes() / 1024 << " KiB)" << std::endl;
+
+    auto start = bench_clock::now();
+    for (const auto& u : stream) books.set_level(u.slot, u.side, u.price, u.qty);
+    report("level update", ns_since(start, updates));
+
+    size_t queries = 1u << 20;
+    double sink = 0;
+    start = bench_clock::now();
+    for (size_t i = 0; i < queries; i++) {
+        sink += books.estimate_fill(static_cast<uint32_t>(i % pairs), Side::Buy, Notional::from_double(1000)).slippage_bps;
+    }
+    report("VWAP for $1000", ns_since(start, queries));
+
+    start = bench_clock::now();
+    for (size_t i = 0; i < queries; i++) sink += books.imbalance(static_cast<uint32_t>(i % pairs), 10);
+    report("imbalance (10 levels)", ns_since(start, queries));
+
+    start = bench_clock::now();
+    for (size_t i = 0; i < queries; i++) sink += books.checksum(static_cast<uint32_t>(i % pairs));
+    report("checksum", ns_since(start, queries));
+
+    std::cout << "  (sink " << sink << ")" << std::endl;
+    return 0;
+}
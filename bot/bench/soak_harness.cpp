@@ -0,0 +1,335 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include "market_sim.hpp"
+#include "learning_engine.hpp"
+#include "portfolio.hpp"
+#include "order_book.hpp"
+#include "strategy_policy.hpp"
+#include "realtime.hpp"
+
+/*
+ * End-to-end soak: synthetic market -> scan -> decide -> execute -> learn,
+ * using the bot's own LearningEngine, PortfolioEngine and OrderBookSet.
+ * Reports sustained events/sec, RSS growth and per-stage latency
+ * percentiles, periodically and at the end.
+ *
+ *   ./soak_harness [--pairs N] [--rate TICKS_PER_PAIR_PER_S] [--duration S]
+ *                  [--speed X] [--report S] [--seed N] [--verbose]
+ *
+ * --speed is simulated seconds per wall second (0 = as fast as possible).
+ * Pairs without a validated strategy trade the learning engine's safe
+ * default, so learning has data from a cold start.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+    struct SoakConfig {
+        MarketSimConfig market;
+        double duration_seconds = 60;    // Wall time
+        double report_seconds = 10;
+        double speed = 0;                // Simulated s per wall s; 0 = unpaced
+        double step_seconds = 0.05;      // Simulated time per advance()
+        double scan_seconds = 1.0;       // Simulated time between scans
+        double position_size_usd = 100;
+        double max_slippage_bps = 25;
+        size_t book_levels = 25;
+        bool verbose = false;
+    };
+
+    struct OpenTrade {
+        uint32_t pair = 0;
+        PortfolioEngine::PairSlot holding = 0;
+        Qty qty;
+        Notional cost;
+        Price entry;
+        StrategyConfig strategy;
+        int64_t opened_us = 0;
+        TickState state;
+        double volatility = 0;
+        double spread = 0;
+    };
+
+    // Swallows the engine's own console output unless --verbose
+    struct NullBuffer : std::streambuf {
+        int overflow(int c) override { return c; }
+    };
+
+    double rss_mb() {
+        std::ifstream statm("/proc/self/statm");
+        long pages = 0, resident = 0;
+        statm >> pages >> resident;
+        return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+    }
+
+    std::string sim_time(int64_t us) {
+        int64_t s = us / 1000000;
+        std::ostringstream out;
+        out << std::setfill('0') << std::setw(2) << s / 3600 << ":" << std::setw(2) << (s / 60) % 60 << ":"
+            << std::setw(2) << s % 60;
+        return out.str();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SoakConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--pairs" && i + 1 < argc) config.market.pairs = std::stoul(argv[++i]);
+        else if (arg == "--rate" && i + 1 < argc) config.market.ticks_per_pair_per_second = std::stod(argv[++i]);
+        else if (arg == "--duration" && i + 1 < argc) config.duration_seconds = std::stod(argv[++i]);
+        else if (arg == "--speed" && i + 1 < argc) config.speed = std::stod(argv[++i]);
+        else if (arg == "--report" && i + 1 < argc) config.report_seconds = std::stod(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) config.market.seed = std::stoull(argv[++i]);
+        else if (arg == "--verbose") config.verbose = true;
+        else {
+            std::cerr << "Unknown option " << arg << " (see the header of soak_harness.cpp)" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostream report(std::cout.rdbuf());
+    NullBuffer null_buffer;
+    if (!config.verbose) std::cout.rdbuf(&null_buffer);
+
+    MarketSimulator market(config.market);
+    LearningEngine learning;
+    RiskLimits limits;
+    limits.max_daily_loss = Notional::from_double(1e9);  // Soak the pipeline, not the breaker
+    PortfolioEngine portfolio(Notional::from_double(100000), limits);
+    OrderBookSet books(market.size(), config.book_levels);
+    const EntryChain<MaxSpread> entry_filter{{MaxSpread{0.1}}};
+    Notional position_size = Notional::from_double(config.position_size_usd);
+
+    std::vector<LearningEngine::PairSlot> pair_slots(market.size());
+    std::vector<OrderBookSet::BookSlot> book_slots(market.size());
+    std::vector<PortfolioEngine::PairSlot> holdings(market.size());
+    for (uint32_t p = 0; p < market.size(); p++) {
+        pair_slots[p] = learning.pair_slot(market.spec(p).pair.str());
+        book_slots[p] = books.slot_for(market.spec(p));
+        holdings[p] = portfolio.slot_for(market.spec(p));
+    }
+
+    std::vector<int> open_by_pair(market.size(), -1);
+    std::vector<OpenTrade> open;
+    std::vector<SimTick> ticks;
+    std::vector<uint32_t> scan_pairs;
+    std::vector<LearningEngine::PairSlot> scan_slots;
+    std::vector<double> scan_volatility;
+    std::vector<const StrategyConfig*> scan_strategy;
+
+    JitterStats tick_latency, scan_latency, execute_latency, learn_latency;
+    uint64_t events = 0, trades = 0, wins = 0, skipped_thin = 0;
+    uint64_t skipped_risk[static_cast<size_t>(RiskVerdict::Unreachable) + 1] = {};
+    Notional pnl;
+
+    // Simulated wall clock for the risk engine's UTC day / cooldown
+    auto sim_epoch = std::chrono::system_clock::now();
+    auto sim_now = [&] { return sim_epoch + std::chrono::microseconds(market.now_us()); };
+
+    auto close_trade = [&](size_t index, ExitReason reason) {
+        OpenTrade trade = open[index];
+        const InstrumentSpec& spec = market.spec(trade.pair);
+        market.build_book(trade.pair, books, book_slots[trade.pair], config.book_levels);
+        FillEstimate fill = books.estimate_fill(book_slots[trade.pair], Side::Sell, trade.qty);
+        Qty sold = fill.filled.lots > 0 ? fill.filled : trade.qty;
+        Price exit = fill.filled.lots > 0 ? spec.price_from_double(fill.average_price) : market.bid(trade.pair);
+        Notional proceeds = fill.filled.lots > 0 ? fill.cost : spec.notional(exit, sold);
+
+        Notional gross = proceeds - trade.cost;
+        Notional fees = Notional::from_double((trade.cost + proceeds).to_double() * 0.0026);  // Taker fee both legs
+        Notional net = gross - fees;
+        portfolio.on_fill(trade.holding, Side::Sell, exit, trade.qty, 1.0);
+        portfolio.charge_fee(fees);
+        portfolio.on_trade_closed(net, sim_now());
+
+        TradeRecord record{};
+        record.pair = spec.pair;
+        record.entry_price = spec.to_double(trade.entry);
+        record.exit_price = spec.to_double(exit);
+        record.leverage = trade.strategy.leverage;
+        record.timeframe_seconds = trade.strategy.timeframe_seconds;
+        record.position_size = config.position_size_usd;
+        record.pnl = net.to_double();
+        record.gross_pnl = gross.to_double();
+        record.fees_paid = fees.to_double();
+        record.timestamp = sim_now();
+        record.exit_reason = reason;
+        record.volatility_at_entry = trade.volatility;
+        record.bid_ask_spread = trade.spread;
+
+        auto learn_start = bench_clock::now();
+        learning.record_trade(record);
+        learn_latency.record(bench_clock::now() - learn_start);
+
+        trades++;
+        if (net.raw > 0) wins++;
+        pnl += net;
+
+        open_by_pair[trade.pair] = -1;
+        if (index + 1 != open.size()) {
+            open[index] = open.back();
+            open_by_pair[open[index].pair] = static_cast<int>(index);
+        }
+        open.pop_back();
+    };
+
+    auto scan_and_enter = [&] {
+        auto scan_start = bench_clock::now();
+        scan_pairs.clear();
+        scan_slots.clear();
+        scan_volatility.clear();
+        for (uint32_t p = 0; p < market.size(); p++) {
+            if (open_by_pair[p] >= 0) continue;
+            double volatility = market.volatility_24h_pct(p);
+            if (!entry_filter.allows({volatility, market.spread_pct(p)})) continue;
+            scan_pairs.push_back(p);
+            scan_slots.push_back(pair_slots[p]);
+            scan_volatility.push_back(volatility);
+        }
+        learning.get_optimal_strategies(scan_slots, scan_volatility, scan_strategy);
+
+        // Same rule as the bot: the most volatile pair, with its strategy
+        size_t chosen = scan_pairs.size();
+        for (size_t j = 0; j < scan_pairs.size(); j++) {
+            if (chosen == scan_pairs.size() || scan_volatility[j] > scan_volatility[chosen]) chosen = j;
+        }
+        scan_latency.record(bench_clock::now() - scan_start);
+        if (chosen == scan_pairs.size()) return;
+
+        auto execute_start = bench_clock::now();
+        uint32_t pair = scan_pairs[chosen];
+        const InstrumentSpec& spec = market.spec(pair);
+        StrategyConfig strategy = *scan_strategy[chosen];
+
+        market.build_book(pair, books, book_slots[pair], config.book_levels);
+        FillEstimate fill = books.estimate_fill(book_slots[pair], Side::Buy, position_size);
+        if (!fill.complete || fill.slippage_bps > config.max_slippage_bps || !spec.meets_minimum(fill.filled)) {
+            skipped_thin++;
+            execute_latency.record(bench_clock::now() - execute_start);
+            return;
+        }
+        Price price = spec.price_from_double(fill.average_price);
+        RiskVerdict verdict = portfolio.check(holdings[pair], Side::Buy, price, fill.filled, strategy.leverage, sim_now());
+        if (verdict != RiskVerdict::Allowed) {
+            skipped_risk[static_cast<size_t>(verdict)]++;
+            execute_latency.record(bench_clock::now() - execute_start);
+            return;
+        }
+        portfolio.on_fill(holdings[pair], Side::Buy, price, fill.filled, strategy.leverage);
+
+        OpenTrade trade;
+        trade.pair = pair;
+        trade.holding = holdings[pair];
+        trade.qty = fill.filled;
+        trade.cost = fill.cost;
+        trade.entry = price;
+        trade.strategy = strategy;
+        trade.opened_us = market.now_us();
+        trade.volatility = scan_volatility[chosen];
+        trade.spread = market.spread_pct(pair);
+        open_by_pair[pair] = static_cast<int>(open.size());
+        open.push_back(std::move(trade));
+        execute_latency.record(bench_clock::now() - execute_start);
+    };
+
+    report << "\n🧪 SOAK: " << market.size() << " pairs @ " << config.market.ticks_per_pair_per_second
+           << " ticks/pair/s, " << config.duration_seconds << "s wall, speed "
+           << (config.speed > 0 ? std::to_string(config.speed) + "x" : std::string("max")) << std::endl;
+
+    double start_rss = rss_mb();
+    auto wall_start = bench_clock::now();
+    auto next_report = wall_start + std::chrono::duration_cast<bench_clock::duration>(
+                                        std::chrono::duration<double>(config.report_seconds));
+    auto wall_end = wall_start + std::chrono::duration_cast<bench_clock::duration>(
+                                     std::chrono::duration<double>(config.duration_seconds));
+    double since_scan = 0;
+    uint64_t events_at_report = 0;
+    auto last_report = wall_start;
+
+    auto print_report = [&](bench_clock::time_point now) {
+        double elapsed = std::chrono::duration<double>(now - wall_start).count();
+        double window = std::chrono::duration<double>(now - last_report).count();
+        double rss = rss_mb();
+        report << "[" << std::setw(6) << std::fixed << std::setprecision(0) << elapsed << "s] sim "
+               << sim_time(market.now_us()) << " | " << events << " events ("
+               << std::setprecision(0) << (events - events_at_report) / std::max(window, 1e-9) << "/s) | "
+               << trades << " trades, " << open.size() << " open | RSS " << std::setprecision(1) << rss
+               << " MB (" << std::showpos << rss - start_rss << std::noshowpos << ")" << std::endl;
+        events_at_report = events;
+        last_report = now;
+    };
+
+    while (true) {
+        auto now = bench_clock::now();
+        if (now >= wall_end) break;
+        if (now >= next_report) {
+            print_report(now);
+            next_report += std::chrono::duration_cast<bench_clock::duration>(
+                std::chrono::duration<double>(config.report_seconds));
+        }
+
+        ticks.clear();
+        market.advance(config.step_seconds, ticks);
+        for (const SimTick& tick : ticks) {
+            auto tick_start = bench_clock::now();
+            events++;
+            int index = open_by_pair[tick.pair];
+            if (index >= 0) {
+                OpenTrade& trade = open[index];
+                const InstrumentSpec& spec = market.spec(tick.pair);
+                portfolio.on_mark(trade.holding, tick.bid);
+                trade.state.pnl = spec.notional(tick.bid, trade.qty) - trade.cost;
+                trade.state.peak = std::max(trade.state.peak, trade.state.pnl);
+                ExitSignal signal = RuntimeExitRule{&trade.strategy, config.position_size_usd}.check(trade.state);
+                bool timed_out = tick.time_us - trade.opened_us >= int64_t{trade.strategy.timeframe_seconds} * 1000000;
+                if (signal.action == ExitAction::Exit) close_trade(index, signal.reason);
+                else if (timed_out) close_trade(index, ExitReason::Timeout);
+            }
+            tick_latency.record(bench_clock::now() - tick_start);
+        }
+
+        since_scan += config.step_seconds;
+        if (since_scan >= config.scan_seconds) {
+            since_scan = 0;
+            scan_and_enter();
+        }
+
+        if (config.speed > 0) {
+            double simulated = market.now_us() / 1e6;
+            std::this_thread::sleep_until(wall_start + std::chrono::duration_cast<bench_clock::duration>(
+                                                           std::chrono::duration<double>(simulated / config.speed)));
+        }
+    }
+
+    auto wall_finish = bench_clock::now();
+    print_report(wall_finish);
+    std::cout.rdbuf(report.rdbuf());
+
+    double wall = std::chrono::duration<double>(wall_finish - wall_start).count();
+    double rss_growth = rss_mb() - start_rss;
+    report << "\n📊 SOAK SUMMARY" << std::endl;
+    report << "  Wall / simulated: " << std::setprecision(1) << wall << "s / " << sim_time(market.now_us()) << std::endl;
+    report << "  Events: " << events << " (" << std::setprecision(0) << events / wall << "/s sustained)" << std::endl;
+    report << "  Trades: " << trades << " (" << std::setprecision(1)
+           << (trades ? 100.0 * wins / trades : 0.0) << "% wins, P&L " << pnl << ")" << std::endl;
+    report << "  Entries skipped: " << skipped_thin << " thin book";
+    for (size_t v = 1; v < std::size(skipped_risk); v++) {
+        if (skipped_risk[v]) report << ", " << skipped_risk[v] << " " << to_string(static_cast<RiskVerdict>(v));
+    }
+    report << std::endl;
+    report << "  RSS growth: " << std::showpos << rss_growth << std::noshowpos << " MB ("
+           << rss_growth / wall * 3600 << " MB/hour)" << std::endl;
+    report << "  Latency (us):" << std::endl;
+    report << "    tick:    " << tick_latency.summary() << std::endl;
+    report << "    scan:    " << scan_latency.summary() << std::endl;
+    report << "    execute: " << execute_latency.summary() << std::endl;
+    report << "    learn:   " << learn_latency.summary() << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "strategy_policy.hpp"
+
+/*
+ * Per-tick exit evaluation cost: specialised policies vs the runtime
+ * StrategyConfig branching the hold loop used to do.
+ *
+ *   ./strategy_policy_bench [ticks]
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+static std::vector<Notional> make_pnl_path(size_t ticks) {
+    // Random walk in cents around zero, like a position's P&L
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> step(0.0, 0.15);
+    std::vector<Notional> path(ticks);
+    double pnl = 0;
+    for (auto& p : path) {
+        pnl += step(rng);
+        if (std::abs(pnl) > 6.0) pnl = 0;  // Start a new "position"
+        p = Notional::from_double(pnl);
+    }
+    return path;
+}
+
+template <ExitRule Rule>
+static void run(const char* name, const Rule& rule, const std::vector<Notional>& path, int reps) {
+    uint64_t exits = 0, partials = 0;
+    auto start = bench_clock::now();
+
+    for (int r = 0; r < reps; r++) {
+        TickState state;
+        for (Notional pnl : path) {
+            state.pnl = pnl;
+            state.peak = std::max(state.peak, pnl);
+            ExitSignal signal = rule.check(state);
+            if (signal.action == ExitAction::Exit) {
+                exits++;
+                state = TickState{};
+            } else if (signal.action == ExitAction::PartialExit) {
+                partials++;
+                state.partial_taken = true;
+            }
+        }
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    double per_tick = ns / (static_cast<double>(path.size()) * reps);
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(2) << std::setw(8) << per_tick << " ns/tick"
+              << "  (exits: " << exits << ", partials: " << partials << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t ticks = argc > 1 ? std::stoul(argv[1]) : (1u << 22);
+    int reps = 5;
+    auto path = make_pnl_path(ticks);
+
+    StrategyConfig config;
+    config.name = "bench";
+    config.take_profit_pct = 0.02;
+    config.stop_loss_pct = 0.03;
+    config.trailing_stop_pct = 0.5;
+    double size_usd = 100;
+
+    std::cout << "\n⏱️  EXIT POLICY BENCHMARK (" << ticks << " ticks x " << reps << ")" << std::endl;
+
+    for (bool trailing : {false, true}) {
+        for (bool partial : {false, true}) {
+            config.use_trailing_stop = trailing;
+            config.use_partial_exits = partial;
+            std::cout << "\n  Shape: trailing=" << (trailing ? "on" : "off")
+                      << " partial=" << (partial ? "on" : "off") << std::endl;
+
+            run("runtime config branching", RuntimeExitRule{&config, size_usd}, path, reps);
+            with_exit_policy(config, size_usd, [&](const auto& rule) {
+                run("specialised policy", rule, path, reps);
+            });
+        }
+    }
+    return 0;
+}
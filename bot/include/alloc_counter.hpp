@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * HEAP ALLOCATION COUNTER
+ *
+ * Built with -DKRAKEN_COUNT_ALLOCATIONS=ON, the global operator new is
+ * replaced with one that bumps a per-thread counter. AllocationScope then
+ * proves a code path (e.g. sizing -> risk check) is allocation-free:
+ * expect_none() aborts a counting build the moment it is not.
+ * tests/alloc_free_test runs the decision path under the counter.
+ * Without the option everything compiles to zeros.
+ */
+
+namespace alloc_counter {
+    bool enabled();
+    uint64_t allocations();  // Heap allocations made by this thread so far
+}
+
+class AllocationScope {
+public:
+    AllocationScope() : start(alloc_counter::allocations()) {}
+    uint64_t count() const { return alloc_counter::allocations() - start; }
+    // Counting builds: abort with `path` if anything was allocated so far
+    void expect_none(const char* path) const;
+
+private:
+    uint64_t start;
+};
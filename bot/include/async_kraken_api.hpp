@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <nlohmann/json.hpp>
+#include "event_loop.hpp"
+#include "kraken_api.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * ASYNCHRONOUS KRAKEN API
+ *
+ * The KrakenAPI surface as awaitable Tasks on an EventLoop. Nothing blocks
+ * the thread while a round-trip is pending, so position monitors and
+ * scanners can run as cheap coroutines side by side.
+ *
+ * Every call is admitted by a RequestScheduler - pass KrakenAPI's so both
+ * clients draw on one rate budget. A private call holds the scheduler's
+ * private lane from admission until its response, and takes its nonce
+ * only once admitted, so private calls from either client reach Kraken
+ * one at a time in nonce order.
+ *
+ * Coroutine arguments are taken by value: a reference parameter could
+ * dangle once the caller's frame moves on.
+ *
+ * base_url is configurable so a local mock server can stand in for
+ * api.kraken.com. Paper mode fills orders locally at the live bid/ask.
+ */
+
+class AsyncKrakenAPI {
+public:
+    AsyncKrakenAPI(EventLoop& loop, RequestScheduler& scheduler, bool paper_trading = true,
+                   std::string base_url = "https://api.kraken.com");
+
+    // Authentication - uses environment variables
+    bool authenticate();
+
+    // Precision for every pair (AssetPairs); call once before trading
+    Task<void> load_instruments();
+    const InstrumentSpec& get_instrument(const Symbol& pair) const { return instruments.get(pair); }
+
+    // Trading
+    Task<Order> place_market_order(Symbol pair, Side side, Qty volume, double leverage = 1.0);
+    Task<bool> cancel_order(OrderId order_id);
+
+    // Positions
+    Task<std::vector<Position>> get_open_positions();
+
+    // Account
+    Task<Notional> get_balance(std::string currency = "USD");
+
+    // Market data
+    Task<json> get_ticker(std::string pair);
+    // One Ticker call per TICKER_BATCH pairs, all in flight together
+    Task<std::map<std::string, json>> get_tickers(std::vector<std::string> pairs);
+    Task<Price> get_current_price(Symbol pair);
+
+    bool is_paper_mode() const { return paper_mode; }
+    EventLoop& event_loop() { return loop; }
+
+    static constexpr size_t TICKER_BATCH = 50;
+
+private:
+    EventLoop& loop;
+    RequestScheduler& scheduler;
+    bool paper_mode;
+    std::string base_url;
+    std::string api_key;
+    std::string api_secret;
+    uint64_t last_nonce = 0;
+
+    InstrumentRegistry instruments;
+
+    // Paper trading state
+    Notional paper_balance = Notional::from_double(10000);
+    std::map<Symbol, Position> paper_positions;
+    uint64_t paper_order_seq = 0;
+
+    // REST helpers - unwrap Kraken's {"error": [...], "result": {...}}
+    Task<json> public_call(std::string method, json params);
+    Task<json> private_call(std::string method, json params, RequestPriority priority, std::string pair = "");
+    Task<json> call(ApiRequest request);
+    HttpRequest signed_request(const ApiRequest& request);
+    std::string sign(const std::string& path, const std::string& nonce, const std::string& postdata) const;
+    std::string next_nonce();
+
+    Task<Order> paper_fill(Symbol pair, Side side, Qty volume, double leverage);
+    static json unwrap(const HttpResponse& response, const std::string& method);
+};
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <coroutine>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <unordered_set>
+#include <curl/curl.h>
+
+/*
+ * SINGLE-THREADED COROUTINE EVENT LOOP
+ *
+ * Task<T> is a lazy C++20 coroutine: nothing runs until it is co_awaited
+ * or handed to EventLoop::spawn(). The loop drives every HTTP request
+ * through one curl multi handle, so thousands of requests and position
+ * monitors can be in flight on one thread.
+ *
+ * The loop owns every spawned task. Tasks still suspended when it is
+ * destroyed are destroyed with it (their requests are cancelled), so
+ * run_until_complete() leaves nothing behind that could outlive the loop.
+ *
+ * The loop is not thread-safe - everything runs on the thread calling run().
+ */
+
+template <typename T>
+class Task;
+
+namespace detail {
+    // Finished task resumes whoever co_awaited it (symmetric transfer)
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            auto next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    template <typename T>
+    struct TaskPromiseBase {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+}
+
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : detail::TaskPromiseBase<T> {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        template <typename U>
+        void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <>
+class Task<void> {
+public:
+    struct promise_type : detail::TaskPromiseBase<void> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() {}
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    void await_resume() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+struct HttpRequest {
+    std::string url;
+    std::string body;                  // Non-empty => POST
+    std::vector<std::string> headers;
+    long timeout_ms = 10000;
+};
+
+struct HttpResponse {
+    long status = 0;
+    std::string body;
+};
+
+class EventLoop {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Requests to one host beyond this many connections wait for a free one
+    explicit EventLoop(long max_host_connections = 8);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Start a task in the background; exceptions are logged, not propagated
+    void spawn(Task<void> task);
+
+    // Resume a suspended coroutine on the next loop iteration
+    void post(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    // Drive the loop until stop() or until nothing is left to do
+    void run();
+    void stop() { stopping = true; }
+
+    // Convenience for synchronous callers (e.g. main). Other spawned tasks
+    // stay suspended until the next run(); throws if the loop stopped or
+    // went idle before `task` finished.
+    template <typename T>
+    T run_until_complete(Task<T> task);
+
+    // Awaitables
+    auto sleep_for(clock::duration d) { return TimerAwaiter{this, clock::now() + d}; }
+    auto http(HttpRequest request) { return HttpAwaiter{this, std::move(request)}; }
+
+    size_t in_flight_requests() const { return active_requests; }
+    size_t live_tasks() const { return detached.size(); }
+
+private:
+    struct TimerAwaiter {
+        EventLoop* loop;
+        clock::time_point deadline;
+        bool await_ready() const noexcept { return deadline <= clock::now(); }
+        void await_suspend(std::coroutine_handle<> h) { loop->timers.push({deadline, h}); }
+        void await_resume() const noexcept {}
+    };
+
+    struct HttpAwaiter {
+        EventLoop* loop;
+        HttpRequest request;
+        HttpResponse response{};
+        std::string error{};
+        CURL* easy = nullptr;
+        curl_slist* header_list = nullptr;
+        char error_buffer[CURL_ERROR_SIZE] = {};
+        std::coroutine_handle<> waiting{};
+
+        ~HttpAwaiter();  // Cancels the transfer if the awaiting task is destroyed
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h);
+        HttpResponse await_resume();
+    };
+
+    struct Timer {
+        clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer& o) const { return deadline > o.deadline; }
+    };
+
+    struct Detached;
+    static Detached start_detached(EventLoop& loop, Task<void> task);
+
+    CURLM* multi = nullptr;
+    std::deque<std::coroutine_handle<>> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+    size_t active_requests = 0;
+    std::unordered_set<void*> detached;  // Frames of spawned tasks still running
+    bool stopping = false;
+
+    void run_ready();
+    void fire_timers();
+    void poll_network(int timeout_ms);
+    static size_t write_callback(char* data, size_t size, size_t nmemb, void* userdata);
+};
+
+// Fire-and-forget wrapper: starts eagerly, frees itself when done. The
+// loop tracks the frame until then, and destroys it if it never finishes.
+struct EventLoop::Detached {
+    struct promise_type {
+        EventLoop& loop;
+
+        promise_type(EventLoop& owner, Task<void>&) : loop(owner) {}
+
+        Detached get_return_object() {
+            loop.detached.insert(std::coroutine_handle<promise_type>::from_promise(*this).address());
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept {
+            loop.detached.erase(std::coroutine_handle<promise_type>::from_promise(*this).address());
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+};
+
+// The outcome lives on the heap: if run() returns early the wrapper task
+// stays with the loop and may still finish on a later run()
+template <typename T>
+T EventLoop::run_until_complete(Task<T> task) {
+    struct Outcome {
+        std::optional<T> value;
+        std::exception_ptr error;
+    };
+    auto outcome = std::make_shared<Outcome>();
+    spawn([](Task<T> t, std::shared_ptr<Outcome> out, EventLoop& loop) -> Task<void> {
+        try {
+            out->value.emplace(co_await t);
+        } catch (...) {
+            out->error = std::current_exception();
+        }
+        loop.stop();
+    }(std::move(task), outcome, *this));
+    run();
+    if (outcome->error) std::rethrow_exception(outcome->error);
+    if (!outcome->value) throw std::runtime_error("Event loop stopped before the task finished");
+    return std::move(*outcome->value);
+}
+
+template <>
+inline void EventLoop::run_until_complete(Task<void> task) {
+    struct Outcome {
+        bool done = false;
+        std::exception_ptr error;
+    };
+    auto outcome = std::make_shared<Outcome>();
+    spawn([](Task<void> t, std::shared_ptr<Outcome> out, EventLoop& loop) -> Task<void> {
+        try {
+            co_await t;
+        } catch (...) {
+            out->error = std::current_exception();
+        }
+        out->done = true;
+        loop.stop();
+    }(std::move(task), outcome, *this));
+    run();
+    if (outcome->error) std::rethrow_exception(outcome->error);
+    if (!outcome->done) throw std::runtime_error("Event loop stopped before the task finished");
+}
+
+// Run tasks concurrently; results come back in input order. The first
+// failure is rethrown once every task has finished.
+template <typename T>
+Task<std::vector<T>> when_all(EventLoop& loop, std::vector<Task<T>> tasks) {
+    struct State {
+        std::vector<std::optional<T>> results;
+        std::exception_ptr error;
+        size_t remaining = 0;
+        std::coroutine_handle<> continuation;
+    };
+    auto state = std::make_shared<State>();
+    state->results.resize(tasks.size());
+    state->remaining = tasks.size();
+
+    for (size_t i = 0; i < tasks.size(); i++) {
+        loop.spawn([](Task<T> t, std::shared_ptr<State> s, size_t index, EventLoop& l) -> Task<void> {
+            try {
+                s->results[index].emplace(co_await t);
+            } catch (...) {
+                if (!s->error) s->error = std::current_exception();
+            }
+            if (--s->remaining == 0 && s->continuation) l.post(s->continuation);
+        }(std::move(tasks[i]), state, i, loop));
+    }
+
+    struct AllDone {
+        std::shared_ptr<State> s;
+        bool await_ready() const noexcept { return s->remaining == 0; }
+        void await_suspend(std::coroutine_handle<> h) { s->continuation = h; }
+        void await_resume() const noexcept {}
+    };
+    // Named, not a temporary: GCC destroys a braced awaiter temporary twice
+    AllDone all_done{state};
+    co_await all_done;
+
+    if (state->error) std::rethrow_exception(state->error);
+    std::vector<T> out;
+    out.reserve(state->results.size());
+    for (auto& r : state->results) out.push_back(std::move(*r));
+    co_return out;
+}
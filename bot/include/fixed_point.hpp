@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <compare>
+#include <string_view>
+#include <charconv>
+#include <stdexcept>
+#include <cmath>
+#include "trading_types.hpp"
+
+/*
+ * FIXED-POINT PRICE / QUANTITY / NOTIONAL
+ *
+ * Prices and quantities are integer counts of the pair's smallest unit:
+ * - Price:    ticks of 10^-pair_decimals  (from AssetPairs)
+ * - Qty:      lots of 10^-lot_decimals    (from AssetPairs)
+ * - Notional: quote currency at a fixed 10^-8, so P&L from different pairs
+ *             with the same quote currency adds up exactly
+ *
+ * Price and Qty carry no scale of their own - they are only meaningful with
+ * the InstrumentSpec of their pair (see instrument.hpp). Compare/add only
+ * values from the same pair; all cross-scale math goes through the spec.
+ */
+
+namespace fixed_point {
+    constexpr int64_t POW10[19] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+        100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+        1000000000000LL, 10000000000000LL, 100000000000000LL,
+        1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL
+    };
+
+    // Divide, rounding half away from zero
+    inline __int128 div_round(__int128 value, __int128 divisor) {
+        __int128 half = divisor / 2;
+        return value >= 0 ? (value + half) / divisor : (value - half) / divisor;
+    }
+
+    // Move a raw value between decimal scales, rounding to nearest
+    inline int64_t rescale(__int128 raw, int from_decimals, int to_decimals) {
+        if (from_decimals == to_decimals) return static_cast<int64_t>(raw);
+        if (from_decimals > to_decimals) {
+            return static_cast<int64_t>(div_round(raw, POW10[from_decimals - to_decimals]));
+        }
+        return static_cast<int64_t>(raw * POW10[to_decimals - from_decimals]);
+    }
+
+    // Exact decimal parse ("43251.10000" -> raw at `decimals`), rounding
+    // surplus digits to nearest. Kraken REST returns numbers as strings.
+    inline int64_t parse(std::string_view text, int decimals) {
+        bool negative = !text.empty() && text.front() == '-';
+        if (negative) text.remove_prefix(1);
+
+        size_t dot = text.find('.');
+        std::string_view int_part = text.substr(0, dot);
+        std::string_view frac_part = dot == std::string_view::npos ? std::string_view() : text.substr(dot + 1);
+
+        int64_t whole = 0;
+        if (!int_part.empty()) {
+            auto [ptr, ec] = std::from_chars(int_part.data(), int_part.data() + int_part.size(), whole);
+            if (ec != std::errc() || ptr != int_part.data() + int_part.size()) {
+                throw std::invalid_argument("Bad decimal: " + std::string(text));
+            }
+        }
+
+        int64_t frac = 0;
+        int digits = 0;
+        bool round_up = false;
+        for (size_t i = 0; i < frac_part.size(); i++) {
+            char c = frac_part[i];
+            if (c < '0' || c > '9') throw std::invalid_argument("Bad decimal: " + std::string(text));
+            if (digits < decimals) {
+                frac = frac * 10 + (c - '0');
+                digits++;
+            } else if (i == static_cast<size_t>(decimals)) {
+                round_up = c >= '5';
+            }
+        }
+        frac *= POW10[decimals - digits];
+
+        int64_t raw = whole * POW10[decimals] + frac + (round_up ? 1 : 0);
+        return negative ? -raw : raw;
+    }
+
+    // Format raw at `decimals` without printf ("4325110" @1 -> "432511.0")
+    template <size_t Capacity>
+    FixedString<Capacity> format(int64_t raw, int decimals) {
+        char buf[Capacity + 1];
+        char* end = buf + sizeof(buf);
+        char* p = end;
+
+        bool negative = raw < 0;
+        uint64_t value = negative ? 0 - static_cast<uint64_t>(raw) : static_cast<uint64_t>(raw);
+
+        for (int i = 0; i < decimals; i++) {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        if (decimals > 0) *--p = '.';
+        do {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0 && p > buf + 1);
+        if (value > 0) throw std::length_error("fixed_point::format overflow");
+        if (negative) *--p = '-';
+
+        return FixedString<Capacity>(std::string_view(p, end - p));
+    }
+}
+
+struct Price {
+    int64_t ticks = 0;
+
+    friend constexpr auto operator<=>(Price a, Price b) = default;
+    constexpr Price operator+(Price o) const { return {ticks + o.ticks}; }
+    constexpr Price operator-(Price o) const { return {ticks - o.ticks}; }
+};
+
+struct Qty {
+    int64_t lots = 0;
+
+    friend constexpr auto operator<=>(Qty a, Qty b) = default;
+    constexpr Qty operator+(Qty o) const { return {lots + o.lots}; }
+    constexpr Qty operator-(Qty o) const { return {lots - o.lots}; }
+    constexpr bool is_zero() const { return lots == 0; }
+};
+
+struct Notional {
+    static constexpr int DECIMALS = 8;
+    int64_t raw = 0;
+
+    static Notional from_double(double value) {
+        return {static_cast<int64_t>(std::llround(value * fixed_point::POW10[DECIMALS]))};
+    }
+    static Notional parse(std::string_view text) { return {fixed_point::parse(text, DECIMALS)}; }
+
+    double to_double() const { return static_cast<double>(raw) / fixed_point::POW10[DECIMALS]; }
+    FixedString<31> format(int decimals = 2) const {
+        return fixed_point::format<31>(fixed_point::rescale(raw, DECIMALS, decimals), decimals);
+    }
+
+    friend constexpr auto operator<=>(Notional a, Notional b) = default;
+    constexpr Notional operator+(Notional o) const { return {raw + o.raw}; }
+    constexpr Notional operator-(Notional o) const { return {raw - o.raw}; }
+    constexpr Notional operator-() const { return {-raw}; }
+    Notional& operator+=(Notional o) { raw += o.raw; return *this; }
+    Notional& operator-=(Notional o) { raw -= o.raw; return *this; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, Notional n) { return os << n.format(); }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "fixed_point.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * INSTRUMENT PRECISION (from Kraken AssetPairs)
+ *
+ * InstrumentSpec turns doubles/strings into Price/Qty at the pair's own
+ * precision and does the cross-scale math (Price x Qty -> Notional, USD
+ * size -> lot-rounded Qty) in exact integer arithmetic.
+ */
+
+struct InstrumentSpec {
+    Symbol pair;               // Kraken key, e.g. "XXBTZUSD"
+    Symbol base;               // Base asset, e.g. "XXBT" (empty if unknown)
+    int pair_decimals = 5;     // Price precision
+    int lot_decimals = 8;      // Volume precision
+    int cost_decimals = 5;     // Quote currency precision
+    Qty ordermin;              // Minimum order volume
+
+    // Conversions at the edges
+    Price price_from_double(double price) const {
+        return {static_cast<int64_t>(std::llround(price * fixed_point::POW10[pair_decimals]))};
+    }
+    Price parse_price(std::string_view text) const { return {fixed_point::parse(text, pair_decimals)}; }
+    Qty parse_qty(std::string_view text) const { return {fixed_point::parse(text, lot_decimals)}; }
+    double to_double(Price p) const { return static_cast<double>(p.ticks) / fixed_point::POW10[pair_decimals]; }
+    double to_double(Qty q) const { return static_cast<double>(q.lots) / fixed_point::POW10[lot_decimals]; }
+
+    // Ready for the AddOrder "price" / "volume" fields
+    FixedString<31> format(Price p) const { return fixed_point::format<31>(p.ticks, pair_decimals); }
+    FixedString<31> format(Qty q) const { return fixed_point::format<31>(q.lots, lot_decimals); }
+
+    // Exact price x volume in quote currency
+    Notional notional(Price p, Qty q) const {
+        __int128 raw = static_cast<__int128>(p.ticks) * q.lots;
+        return {fixed_point::rescale(raw, pair_decimals + lot_decimals, Notional::DECIMALS)};
+    }
+
+    // Largest lot-aligned volume whose cost does not exceed `budget`
+    Qty qty_for_notional(Notional budget, Price p) const {
+        if (p.ticks <= 0 || budget.raw <= 0) return {};
+        __int128 num = static_cast<__int128>(budget.raw) * fixed_point::POW10[pair_decimals + lot_decimals];
+        __int128 den = static_cast<__int128>(p.ticks) * fixed_point::POW10[Notional::DECIMALS];
+        return {static_cast<int64_t>(num / den)};
+    }
+
+    // Round an arbitrary volume down to the pair's lot size
+    Qty qty_floor(double volume) const {
+        return {static_cast<int64_t>(std::floor(volume * fixed_point::POW10[lot_decimals]))};
+    }
+
+    bool meets_minimum(Qty q) const { return q >= ordermin; }
+};
+
+// Lets string-keyed maps be searched by string_view / Symbol without
+// building a std::string per lookup
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+template <typename V>
+using StringMap = std::unordered_map<std::string, V, StringHash, std::equal_to<>>;
+
+class InstrumentRegistry {
+public:
+    // `asset_pairs` is the "result" object of /0/public/AssetPairs
+    void load_asset_pairs(const json& asset_pairs);
+    bool load_from_file(const std::string& filepath);
+
+    // Lookup by Kraken key, altname ("XBTUSD") or wsname ("XBT/USD")
+    const InstrumentSpec* find(std::string_view pair) const;
+    const InstrumentSpec& get(std::string_view pair) const;  // throws std::out_of_range
+
+    size_t size() const { return specs.size(); }
+
+private:
+    std::vector<InstrumentSpec> specs;
+    StringMap<size_t> index;  // any name -> specs slot
+};
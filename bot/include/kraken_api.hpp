@@ -8,26 +8,33 @@
 #include <curl/curl.h>
 #include <thread>
 #include <queue>
+#include "request_scheduler.hpp"
+#include "trading_types.hpp"
+#include "object_pool.hpp"
+#include "instrument.hpp"
+#include "session_log.hpp"
 
 using json = nlohmann::json;
 
+// Order/Position hold no heap memory - see trading_types.hpp.
+// Prices/volumes are fixed-point at the pair's AssetPairs precision.
 struct Order {
-    std::string order_id;
-    std::string pair;
-    std::string side;  // "buy" or "sell"
-    double price;
-    double volume;
-    double filled;
-    std::string status;  // "pending", "filled", "cancelled"
+    OrderId order_id;
+    Symbol pair;
+    Side side = Side::Buy;
+    Price price;
+    Qty volume;
+    Qty filled;
+    OrderStatus status = OrderStatus::Pending;
 };
 
 struct Position {
-    std::string pair;
-    double size;
-    double entry_price;
-    double leverage;
-    double current_price;
-    double unrealized_pnl;
+    Symbol pair;
+    Qty size;
+    Price entry_price;
+    double leverage = 1.0;
+    Price current_price;
+    Notional unrealized_pnl;
 };
 
 class KrakenAPI {
@@ -39,26 +46,38 @@ public:
     bool authenticate();
     
     // Trading
-    Order place_market_order(const std::string& pair, const std::string& side, 
-                            double volume, double leverage = 1.0);
-    Order place_limit_order(const std::string& pair, const std::string& side,
-                           double volume, double price, double leverage = 1.0);
-    bool cancel_order(const std::string& order_id);
+    Order place_market_order(const Symbol& pair, Side side, 
+                            Qty volume, double leverage = 1.0);
+    Order place_limit_order(const Symbol& pair, Side side,
+                           Qty volume, Price price, double leverage = 1.0);
+    bool cancel_order(const OrderId& order_id);
     
     // Positions
     std::vector<Position> get_open_positions();
-    Position get_position(const std::string& pair);
-    bool close_position(const std::string& pair);
+    Position get_position(const Symbol& pair);
+    bool close_position(const Symbol& pair);
     
     // Account
-    double get_balance(const std::string& currency = "USD");
-    double get_equity();
+    Notional get_balance(const std::string& currency = "USD");
+    Notional get_equity();
     
     // Market data
-    double get_current_price(const std::string& pair);
+    Price get_current_price(const Symbol& pair);
     json get_ticker(const std::string& pair);
-    double get_bid_ask_spread(const std::string& pair);
+    std::map<std::string, json> get_tickers(const std::vector<std::string>& pairs);  // One batched call
+    double get_bid_ask_spread(const Symbol& pair);
     std::vector<std::string> get_trading_pairs();
+    // REST Depth for one pair ({"asks": [...], "bids": [...]}) - see order_book.hpp
+    json get_depth(const std::string& pair, int count = 100) {
+        ApiRequest request;
+        request.endpoint = "/0/public/Depth";
+        request.params = {{"pair", pair}, {"count", count}};
+        json result = scheduler->call(std::move(request));
+        return result.empty() ? json::object() : result.begin().value();
+    }
+    
+    // Per-pair precision (AssetPairs pair_decimals / lot_decimals)
+    const InstrumentSpec& get_instrument(const Symbol& pair) const { return instruments.get(pair); }
     
     // Paper trading
     void set_paper_mode(bool enabled) { paper_mode = enabled; }
@@ -67,22 +86,54 @@ public:
     // Deploy live (one-click)
     bool deploy_live();
     
+    // Rate limiting - every REST call goes through the scheduler
+    void set_rate_limit_tier(RateLimitTier tier);
+    SchedulerStats get_scheduler_stats() const { return scheduler->get_stats(); }
+    // Shared with AsyncKrakenAPI so both clients draw on one budget
+    RequestScheduler& request_scheduler() { return *scheduler; }
+    // One of `processes` on this key (sharded workers) - call before any request
+    void share_rate_limits(uint32_t processes) { scheduler->share_limits(processes); }
+    
+    // Wrap the REST transport (e.g. ShardLink::serialize_private) - call before any request
+    void wrap_transport(const std::function<RequestScheduler::Transport(RequestScheduler::Transport)>& wrapper) {
+        scheduler->wrap_transport(wrapper);
+    }
+    
+    // Session capture / replay (session_log.hpp) - call before any request
+    void capture_session(const std::string& path) {
+        auto recorder = std::make_shared<SessionRecorder>(path);
+        scheduler->wrap_transport([&](RequestScheduler::Transport inner) { return recorder->wrap(std::move(inner)); });
+    }
+    void replay_session(const std::string& path, double speed) {
+        auto replayer = std::make_shared<SessionReplayer>(path, speed);
+        scheduler->wrap_transport([&](RequestScheduler::Transport) { return replayer->transport(); });
+        scheduler->set_time_scale(speed > 0 ? speed : 1e6);  // Rate limits run on replay time
+    }
+    
 private:
     bool paper_mode;
     std::string api_key;
     std::string api_secret;
     std::string base_url = "https://api.kraken.com";
     
-    // Paper trading state
-    double paper_balance = 10000;  // $10k starting
-    std::map<std::string, Position> paper_positions;
-    std::map<std::string, Order> paper_orders;
+    // Paper trading state - map nodes come from pools, not the heap
+    Notional paper_balance = Notional::from_double(10000);  // $10k starting
+    NodePool position_nodes{256, 64};
+    NodePool order_nodes{256, 256};
+    PooledMap<Symbol, Position> paper_positions{PoolAllocator<std::pair<const Symbol, Position>>(&position_nodes)};
+    PooledMap<OrderId, Order> paper_orders{PoolAllocator<std::pair<const OrderId, Order>>(&order_nodes)};
     
     // HTTP helpers
     json http_get(const std::string& endpoint);
     json http_post(const std::string& endpoint, const json& data);
     std::string hmac_sha256(const std::string& message);
     
+    // Priority/rate-limit scheduling (transport = http_get/http_post)
+    std::unique_ptr<RequestScheduler> scheduler;
+    
+    // Loaded from AssetPairs on authenticate()
+    InstrumentRegistry instruments;
+    
     // Mock data
     std::map<std::string, double> mock_prices;
 };
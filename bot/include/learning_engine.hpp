@@ -9,6 +9,10 @@
 #include <deque>
 #include <cmath>
 #include <algorithm>
+#include <unordered_map>
+#include "trading_types.hpp"
+
+class StatsPublisher;
 
 using json = nlohmann::json;
 using namespace std::chrono;
@@ -29,7 +33,7 @@ using namespace std::chrono;
  */
 
 struct TradeRecord {
-    std::string pair;
+    Symbol pair;
     double entry_price;
     double exit_price;
     double leverage;
@@ -39,7 +43,7 @@ struct TradeRecord {
     double gross_pnl;      // Before fees
     double fees_paid;
     system_clock::time_point timestamp;
-    std::string exit_reason;  // "take_profit", "stop_loss", "timeout", "manual"
+    ExitReason exit_reason = ExitReason::Manual;
     double volatility_at_entry;  // % volatility of pair
     double bid_ask_spread;       // At entry time
     int bars_high;         // Bars since entry until peak
@@ -119,6 +123,16 @@ public:
     // Get best strategy based on current data
     StrategyConfig get_optimal_strategy(const std::string& pair, double current_volatility);
     
+    // Batched lookup: resolve each pair to a slot once, then score every
+    // pair per scan against the precomputed index. out[i] is the best
+    // validated strategy (highest Sharpe) for slots[i] at volatilities[i],
+    // or the safe default (is_validated == false) if there is none; never
+    // nullptr. Pointers stay valid until the next update_strategy_database().
+    using PairSlot = uint32_t;
+    PairSlot pair_slot(const std::string& pair);
+    void get_optimal_strategies(const std::vector<PairSlot>& slots, const std::vector<double>& volatilities,
+                                std::vector<const StrategyConfig*>& out) const;
+    
     // Self-learning: update strategy database after analysis
     void update_strategy_database();
     
@@ -140,15 +154,42 @@ public:
     json get_statistics_json() const;
     void print_summary() const;
     
+    // Live export: every recorded trade is pushed to the shared stats segment
+    void set_stats_publisher(StatsPublisher* publisher) { stats_publisher = publisher; }
+    
 private:
     // Trade history
     std::deque<TradeRecord> trade_history;
     std::map<std::string, std::vector<TradeRecord>> trades_by_pair;
     std::map<std::string, std::vector<TradeRecord>> trades_by_strategy;  // pattern key
     
+    // Running totals so statistics/regime queries are O(1)
+    double running_pnl = 0;
+    int running_wins = 0;
+    std::deque<double> recent_rois;   // Last REGIME_LOOKBACK trade ROIs
+    double recent_roi_sum = 0;
+    double recent_roi_sq_sum = 0;
+    StatsPublisher* stats_publisher = nullptr;
+    
     // Learned patterns
     std::map<std::string, PatternMetrics> pattern_database;  // key = "pair_leverage_timeframe"
     std::vector<StrategyConfig> strategy_configs;
+    StrategyConfig safe_default;  // For pairs with no validated strategy
+    
+    // Best-strategy index, rebuilt only by update_strategy_database().
+    // Entries are grouped by pair and sorted by min_volatility; best_config
+    // is the highest-Sharpe strategy among that entry and the ones before
+    // it, so a lookup is one binary search inside the pair's range.
+    struct StrategyIndexEntry {
+        double min_volatility;
+        uint32_t best_config;
+    };
+    std::vector<StrategyIndexEntry> strategy_index;
+    std::vector<std::pair<uint32_t, uint32_t>> strategy_index_ranges;  // [begin, end) by PairSlot
+    std::unordered_map<std::string, PairSlot> pair_slots;               // Stable for the session
+    
+    void rebuild_strategy_index();
+    const StrategyConfig* lookup_strategy(PairSlot slot, double current_volatility) const;
     
     // Statistical helpers
     double calculate_std_dev(const std::vector<double>& values) const;
@@ -159,6 +200,7 @@ private:
     
     // Pattern matching
     std::string generate_pattern_key(const std::string& pair, double leverage, int timeframe) const;
+    static int timeframe_bucket(int timeframe_seconds);
     void identify_winning_patterns();
     void correlate_patterns();
     void detect_regime_shifts();
@@ -180,4 +222,5 @@ private:
     const double CONFIDENCE_THRESHOLD = 0.6;  // 60% confidence needed
     const double MIN_WIN_RATE_FOR_TRADE = 0.45;  // Must be > 45% to trade
     const double OUTLIER_THRESHOLD = 2.5;  // 2.5 std devs
+    static constexpr size_t REGIME_LOOKBACK = 20;
 };
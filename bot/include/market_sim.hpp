@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "instrument.hpp"
+#include "trading_types.hpp"
+#include "order_book.hpp"
+
+/*
+ * SYNTHETIC MARKET GENERATOR
+ *
+ * Produces tick streams for hundreds of made-up pairs ("SIM0001USD"...)
+ * for load and soak testing. The model for each pair, in simulated time:
+ * - mid price: geometric Brownian motion plus Poisson jumps (log-normal
+ *   jump sizes)
+ * - spread: mean-reverting (Ornstein-Uhlenbeck in log space) around the
+ *   pair's base spread, widened by jumps and volume bursts
+ * - activity: a two-state calm/burst regime. Bursts multiply the tick
+ *   rate, the traded volume and the volatility until they decay.
+ *
+ * advance(dt) moves every pair one step and emits a tick for each pair
+ * whose Poisson arrival fires, so the event rate is set by the config and
+ * the current burst state. The state lives in flat per-pair arrays and
+ * advance() appends into a caller-owned vector, so generation does not
+ * allocate in steady state.
+ *
+ * Every pair also has an InstrumentSpec (precision scaled to its price),
+ * and build_book() lays a synthetic L2 book around the current bid/ask for
+ * execution against OrderBookSet.
+ *
+ * Fully deterministic for a given seed.
+ */
+
+struct MarketSimConfig {
+    size_t pairs = 200;
+    double ticks_per_pair_per_second = 2.0;   // Calm-regime arrival rate
+    double min_daily_volatility_pct = 1.0;    // Per-pair sigma drawn from this range
+    double max_daily_volatility_pct = 12.0;
+    double drift_per_day_pct = 0.0;
+    double jumps_per_day = 6.0;               // Poisson intensity per pair
+    double jump_std_pct = 1.5;                // Log jump size std dev
+    double base_spread_bps = 4.0;             // Median base spread (per pair x0.25..x4)
+    double spread_reversion_per_second = 0.2;
+    double spread_vol = 0.5;                  // Log-spread diffusion per sqrt(second)
+    double jump_spread_multiplier = 4.0;      // Spread widening on a jump
+    double bursts_per_hour = 2.0;             // Per pair
+    double burst_mean_seconds = 60.0;
+    double burst_multiplier = 8.0;            // Rate / volume multiplier while bursting
+    double book_depth_usd = 20000.0;          // Resting size near the touch
+    uint64_t seed = 42;
+};
+
+struct SimTick {
+    uint32_t pair = 0;
+    int64_t time_us = 0;      // Simulated time
+    Price bid;
+    Price ask;
+    Price last;
+    Qty volume;
+    bool jump = false;        // A jump happened since the pair's last tick
+    bool burst = false;
+};
+
+class MarketSimulator {
+public:
+    explicit MarketSimulator(const MarketSimConfig& config);
+
+    // Advance simulated time by dt_seconds; appends the ticks that fired, in
+    // pair order, and returns how many
+    size_t advance(double dt_seconds, std::vector<SimTick>& out);
+
+    size_t size() const { return specs.size(); }
+    const InstrumentSpec& spec(uint32_t pair) const { return specs[pair]; }
+    const std::vector<InstrumentSpec>& instruments() const { return specs; }
+    int64_t now_us() const { return clock_us; }
+
+    // Current state of a pair
+    double mid(uint32_t pair) const { return state[pair].mid; }
+    double spread_pct(uint32_t pair) const { return state[pair].spread_bps / 100.0; }
+    Price bid(uint32_t pair) const;
+    Price ask(uint32_t pair) const;
+    // Realised volatility (EWMA), scaled to a 24h % like Kraken's vola_24h
+    double volatility_24h_pct(uint32_t pair) const;
+    bool bursting(uint32_t pair) const { return state[pair].burst; }
+
+    // Synthetic L2 around the current bid/ask: deeper levels hold more,
+    // wide spreads and bursts thin the book
+    void build_book(uint32_t pair, OrderBookSet& books, OrderBookSet::BookSlot slot, size_t levels);
+
+private:
+    struct PairState {
+        double mid = 100;
+        double sigma = 0;          // Per sqrt(second)
+        double base_spread_bps = 4;
+        double spread_bps = 4;
+        double ewma_var = 0;       // Squared log return per second
+        double last_mid = 100;
+        double since_tick = 0;     // Seconds since the last emitted tick
+        bool burst = false;
+        bool jumped = false;
+    };
+
+    MarketSimConfig config;
+    std::vector<InstrumentSpec> specs;
+    std::vector<PairState> state;
+    std::mt19937_64 rng;
+    std::normal_distribution<double> normal{0.0, 1.0};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    int64_t clock_us = 0;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <memory>
+#include <map>
+#include <functional>
+
+/*
+ * OBJECT POOLS FOR ORDER / POSITION RECORDS
+ *
+ * NodePool hands out fixed-size blocks from chunks it never returns to the
+ * heap. Freed blocks go on an intrusive free list, so after warm-up (or an
+ * explicit reserve()) inserting and erasing orders/positions costs zero
+ * heap allocations.
+ *
+ * PoolAllocator adapts a NodePool to STL node containers; PooledMap is the
+ * std::map used for paper_positions / paper_orders.
+ *
+ * Not thread-safe: each pool belongs to the thread that owns its container.
+ */
+
+class NodePool {
+public:
+    explicit NodePool(size_t block_size = 256, size_t blocks_per_chunk = 64)
+        : block_size_(round_up(std::max(block_size, sizeof(FreeBlock)))),
+          blocks_per_chunk_(blocks_per_chunk) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate() {
+        if (!free_list) grow();
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        in_use++;
+        return block;
+    }
+
+    void deallocate(void* p) {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = free_list;
+        free_list = block;
+        in_use--;
+    }
+
+    // Pre-allocate so the trading loop never grows the pool
+    void reserve(size_t blocks) {
+        while (capacity() < blocks) grow();
+    }
+
+    size_t block_size() const { return block_size_; }
+    size_t capacity() const { return chunks.size() * blocks_per_chunk_; }
+    size_t blocks_in_use() const { return in_use; }
+    size_t chunk_count() const { return chunks.size(); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t block_size_;
+    size_t blocks_per_chunk_;
+    FreeBlock* free_list = nullptr;
+    size_t in_use = 0;
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+
+    static size_t round_up(size_t n) {
+        constexpr size_t align = alignof(std::max_align_t);
+        return (n + align - 1) / align * align;
+    }
+
+    void grow() {
+        // Slow path: the only place this pool touches the heap
+        chunks.emplace_back(new std::byte[block_size_ * blocks_per_chunk_]);
+        std::byte* base = chunks.back().get();
+        for (size_t i = blocks_per_chunk_; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(base + i * block_size_);
+            block->next = free_list;
+            free_list = block;
+        }
+    }
+};
+
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(NodePool* pool) noexcept : pool(pool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(size_t n) {
+        // Single nodes come from the pool; anything bigger is not a hot-path node
+        if (n == 1 && sizeof(T) <= pool->block_size() && alignof(T) <= alignof(std::max_align_t)) {
+            return static_cast<T*>(pool->allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n == 1 && sizeof(T) <= pool->block_size() && alignof(T) <= alignof(std::max_align_t)) {
+            pool->deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept { return pool == other.pool; }
+
+private:
+    template <typename U> friend class PoolAllocator;
+    NodePool* pool;
+};
+
+template <typename K, typename V>
+using PooledMap = std::map<K, V, std::less<>, PoolAllocator<std::pair<const K, V>>>;
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "instrument.hpp"
+#include "trading_types.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * L2 ORDER BOOKS (FLAT PRICE-LEVEL ARRAYS)
+ *
+ * One OrderBookSet holds the books of every tracked pair in a single
+ * arena allocated up front:
+ *
+ *   max_pairs x 2 sides x 2 x depth x BookLevel (16 B)
+ *
+ * so memory stays bounded however many updates arrive. Each side is a
+ * sorted array of (price ticks, qty lots) with the best level LAST. Most
+ * updates land near the top of the book, so inserting or removing a level
+ * only shifts the few entries above it. Like Kraken, a side is cut back to
+ * `depth` levels after every update. Each side has room for twice that, so
+ * dropping the worst level just advances the side's start; the levels are
+ * slid back down only when the top reaches the end of the room.
+ *
+ * Sources:
+ * - REST Depth results and WS v1 snapshots ({"as"/"asks", "bs"/"bids"})
+ * - WS v1 updates ([id, {"a":...}, {"b":..., "c":"crc"}, "book-N", pair])
+ * - WS v2 "book" channel snapshots and updates
+ *
+ * Kraken's checksum is a CRC32 over the top 10 asks then the top 10 bids,
+ * each level written as price then qty with the decimal point and leading
+ * zeros removed - i.e. the decimal integers at the precision the messages
+ * use. v2 sends the pair's own precision. v1 strings often carry more
+ * decimals ("5541.30000" for a 1-decimal pair), so the snapshot's string
+ * precision is remembered and ticks/lots are scaled up to it. A mismatch
+ * marks the book out of sync until the next snapshot.
+ *
+ * Queries (best bid/ask, VWAP to fill a size, depth imbalance) walk at
+ * most `depth` contiguous levels and never allocate.
+ *
+ * Not thread-safe; one owner per set.
+ */
+
+struct BookLevel {
+    int64_t ticks = 0;   // Price at pair_decimals
+    int64_t lots = 0;    // Qty at lot_decimals
+};
+
+// Cost of filling a size against the book, as a taker
+struct FillEstimate {
+    Qty filled;
+    Notional cost;
+    Price worst;                  // Deepest level touched
+    bool complete = false;        // False when the book ran out first
+    double average_price = 0;     // cost / filled
+    double slippage_bps = 0;      // Average vs best price, always >= 0
+};
+
+class OrderBookSet {
+public:
+    using BookSlot = uint32_t;
+
+    static constexpr size_t CHECKSUM_LEVELS = 10;
+
+    OrderBookSet(size_t max_pairs, size_t depth = 100);
+
+    // Book for a pair, created on first use; throws std::length_error past max_pairs.
+    // `spec` must outlive the set (InstrumentRegistry entries do).
+    BookSlot slot_for(const InstrumentSpec& spec);
+    // Extra name for WS messages (e.g. wsname "XBT/USD" for "XXBTZUSD")
+    void add_alias(std::string_view name, BookSlot slot);
+    const BookSlot* find(std::string_view name) const;
+
+    // Level edits; qty 0 removes the level
+    void set_level(BookSlot slot, Side side, Price price, Qty qty);
+    void clear(BookSlot slot);
+
+    // REST Depth result for one pair, or a WS v1 snapshot payload
+    void apply_snapshot(BookSlot slot, const json& book);
+    // WS v1/v2 book message; false if a checksum did not match, the book
+    // is waiting for a snapshot or the pair is unknown. Other channels are
+    // ignored. Throws on malformed messages.
+    bool apply_ws_message(const json& message);
+
+    uint32_t checksum(BookSlot slot) const;
+    bool in_sync(BookSlot slot) const { return books[slot].synced; }
+    uint64_t checksum_failures() const { return failures; }
+
+    // Queries
+    Price best_bid(BookSlot slot) const;   // 0 ticks when the side is empty
+    Price best_ask(BookSlot slot) const;
+    size_t levels(BookSlot slot, Side side) const;
+    BookLevel level(BookSlot slot, Side side, size_t from_best) const;
+
+    // Taker fill walking the opposite side: Buy spends `budget` on asks,
+    // Sell sells `qty` into bids
+    FillEstimate estimate_fill(BookSlot slot, Side taker, Notional budget) const;
+    FillEstimate estimate_fill(BookSlot slot, Side taker, Qty qty) const;
+
+    // (bid qty - ask qty) / (bid qty + ask qty) over the top `levels`; 0 if empty
+    double imbalance(BookSlot slot, size_t levels = 10) const;
+
+    size_t depth() const { return max_depth; }
+    size_t memory_bytes() const { return arena.capacity() * sizeof(BookLevel) + books.capacity() * sizeof(Book); }
+
+    static uint32_t crc32(const char* data, size_t length, uint32_t crc = 0);
+
+private:
+    struct Book {
+        const InstrumentSpec* spec = nullptr;
+        uint32_t begin[2] = {0, 0};   // Indexed by Side; worst level's index
+        uint32_t count[2] = {0, 0};
+        int8_t wire_price_decimals = 0;  // Precision used on the wire (checksum)
+        int8_t wire_qty_decimals = 0;
+        bool synced = false;
+    };
+
+    size_t max_pairs;
+    size_t max_depth;
+    std::vector<BookLevel> arena;     // [pair][side][2 x depth]
+    std::vector<Book> books;
+    StringMap<BookSlot> names;
+    uint64_t failures = 0;
+
+    BookLevel* side_levels(BookSlot slot, Side side) {
+        return arena.data() + (static_cast<size_t>(slot) * 2 + static_cast<size_t>(side)) * 2 * max_depth;
+    }
+    const BookLevel* side_levels(BookSlot slot, Side side) const {
+        return arena.data() + (static_cast<size_t>(slot) * 2 + static_cast<size_t>(side)) * 2 * max_depth;
+    }
+
+    void apply_levels(BookSlot slot, Side side, const json& levels);
+    bool apply_v1(const json& message);
+    bool apply_v2(const json& message);
+    bool verify(BookSlot slot, uint32_t expected);
+    template <typename Budget>
+    FillEstimate walk(BookSlot slot, Side taker, Budget remaining) const;
+};
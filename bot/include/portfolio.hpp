@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include "instrument.hpp"
+#include "kraken_api.hpp"
+
+/*
+ * INCREMENTAL PORTFOLIO & RISK ENGINE
+ *
+ * Each pair gets a slot when it is first traded. A slot keeps the
+ * position's signed lots, cost basis, last mark and leverage. Account
+ * totals are kept as running sums:
+ * - unrealized P&L and realized P&L (after fees)
+ * - exposure per base asset and gross exposure, both leverage-weighted
+ *   (|price x qty| x leverage)
+ * - equity, intraday peak equity and intraday drawdown
+ *
+ * A fill or mark only applies the difference between the slot's old and
+ * new contribution to those sums, so every update is O(1) whatever the
+ * number of pairs or open positions.
+ *
+ * check() is the pre-trade gate in front of every entry order. It uses
+ * integer comparisons against the running sums only, so it costs tens
+ * of nanoseconds. It enforces the README risk rules:
+ * - daily loss circuit breaker: once equity is max_daily_loss below the
+ *   UTC day's opening equity, new entries stop until the next UTC day and
+ *   halted() asks open positions to close
+ * - cooldown: after max_consecutive_losses losing trades in a row, no
+ *   entries for loss_cooldown
+ * - max concurrent positions, per-asset and gross leverage caps
+ * Orders that only reduce a position are always allowed.
+ *
+ * Not thread-safe: the execution path owns it (the execution thread in
+ * threaded mode).
+ */
+
+struct RiskLimits {
+    Notional max_daily_loss = Notional::from_double(500);
+    int max_consecutive_losses = 3;
+    std::chrono::seconds loss_cooldown{300};
+    size_t max_positions = 5;
+    Notional max_asset_exposure = Notional::from_double(1000);  // Leverage-weighted, per base asset
+    double max_gross_leverage = 3.0;                            // Gross exposure / equity
+};
+
+enum class RiskVerdict : uint8_t {
+    Allowed,
+    DailyLossLimit,
+    Cooldown,
+    MaxPositions,
+    AssetExposure,
+    GrossLeverage,
+    Unreachable      // Sharded mode: no answer from the risk coordinator
+};
+
+const char* to_string(RiskVerdict verdict);
+
+class PortfolioEngine {
+public:
+    using PairSlot = uint32_t;
+    using clock = std::chrono::system_clock;
+
+    PortfolioEngine(Notional starting_equity, RiskLimits limits = {});
+
+    // Slot for a pair, registered on first use (per-asset bucket = spec.base)
+    PairSlot slot_for(const InstrumentSpec& spec);
+
+    // Pre-trade check, O(1)
+    RiskVerdict check(PairSlot slot, Side side, Price price, Qty volume, double leverage,
+                      clock::time_point now = clock::now());
+    // Day limit / cooldown only - "may anything be opened right now?"
+    RiskVerdict entry_gate(clock::time_point now = clock::now());
+
+    // Position updates, O(1)
+    void on_fill(PairSlot slot, Side side, Price price, Qty volume, double leverage);
+    void on_mark(PairSlot slot, Price mark);
+    void charge_fee(Notional fee);
+    // Closed round trip; feeds the consecutive-loss cooldown
+    void on_trade_closed(Notional net_pnl, clock::time_point now = clock::now());
+
+    // Running totals
+    Notional equity() const { return starting_equity + realized + unrealized; }
+    Notional unrealized_pnl() const { return unrealized; }
+    Notional realized_pnl() const { return realized; }
+    Notional gross_exposure() const { return gross; }
+    Notional asset_exposure(PairSlot slot) const { return assets[slots[slot].asset].exposure; }
+    Notional daily_pnl() const { return equity() - day_start_equity; }
+    Notional intraday_drawdown() const { return day_peak_equity - equity(); }
+    Notional max_intraday_drawdown() const { return day_max_drawdown; }
+    size_t open_positions() const { return open_count; }
+    int consecutive_losses() const { return loss_streak; }
+    clock::time_point cooldown_until() const { return cooldown_end; }
+    bool halted() const { return day_halted; }  // Circuit breaker tripped today
+
+    // Open positions with their live mark / unrealized P&L, O(open pairs)
+    std::vector<Position> positions() const;
+
+private:
+    struct Slot {
+        const InstrumentSpec* spec = nullptr;
+        uint32_t asset = 0;
+        int64_t lots = 0;       // Signed: > 0 long, < 0 short
+        Notional cost;          // Signed cost basis of `lots`
+        Notional value;         // Signed notional at `mark`
+        Notional upnl;          // value - cost, as counted in `unrealized`
+        Notional weighted;      // |value| x leverage, as counted in the exposure sums
+        Price entry;
+        Price mark;
+        double leverage = 1.0;
+    };
+
+    struct Asset {
+        Notional exposure;
+    };
+
+    RiskLimits limits;
+    Notional starting_equity;
+
+    std::vector<Slot> slots;
+    std::vector<Asset> assets;
+    std::unordered_map<Symbol, PairSlot> slot_index;
+    std::unordered_map<Symbol, uint32_t> asset_index;
+
+    Notional realized;
+    Notional unrealized;
+    Notional gross;
+    size_t open_count = 0;
+
+    int64_t day = 0;                  // UTC day number of the figures below
+    Notional day_start_equity;
+    Notional day_peak_equity;
+    Notional day_max_drawdown;
+    bool day_halted = false;
+
+    int loss_streak = 0;
+    clock::time_point cooldown_end{};
+
+    void remark(Slot& slot, Price mark);
+    void update_equity();
+    void roll_day(clock::time_point now);
+    static Notional leverage_weighted(Notional value, double leverage);
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+/*
+ * LOW-JITTER THREADING PRIMITIVES
+ *
+ * The threaded bot splits the loop into feed -> strategy -> execution ->
+ * analytics threads joined by single-producer/single-consumer queues.
+ * For isolated cores (isolcpus/nohz_full) each thread can be:
+ * - pinned to one CPU (pin_current_thread)
+ * - busy-polling its queue/timer instead of sleeping in the kernel
+ *   (queue spins never give the core back, so only use them on cores
+ *   nothing else needs; timed waits only spin their last SPIN_WINDOW)
+ * - running on memory that is locked (lock_process_memory) and, for the
+ *   queues, backed by huge pages (HugePageBuffer)
+ *
+ * JitterStats measures how late each wake-up was against its deadline, or
+ * how long a queue handoff took. That gives the before/after numbers for
+ * the OS scheduler vs spinning on an isolated core.
+ */
+
+namespace realtime {
+    using clock = std::chrono::steady_clock;
+
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // False (and a warning) if the CPU is unavailable or not permitted
+    bool pin_current_thread(int cpu, const char* name);
+    // mlockall(MCL_CURRENT | MCL_FUTURE); needs CAP_IPC_LOCK or a high memlock ulimit
+    bool lock_process_memory();
+
+    // Busy-poll waits sleep until this close to the deadline, then spin, so
+    // long waits (a 1 s hold tick) don't burn the core but still wake on time
+    constexpr auto SPIN_WINDOW = std::chrono::milliseconds(1);
+
+    // Sleep or spin until `deadline`; returns how late we actually woke
+    inline clock::duration wait_until(clock::time_point deadline, bool busy_poll) {
+        if (busy_poll) {
+            if (deadline - clock::now() > SPIN_WINDOW) std::this_thread::sleep_until(deadline - SPIN_WINDOW);
+            while (clock::now() < deadline) cpu_relax();
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+        return clock::now() - deadline;
+    }
+}
+
+// Wake-up / handoff latency histogram (log-linear: 8 sub-buckets per power
+// of two, <= 12.5% error). One per thread; read it after the thread joins.
+class JitterStats {
+public:
+    void record(std::chrono::nanoseconds late);
+
+    uint64_t count() const { return samples; }
+    double percentile_us(double q) const;
+    double max_us() const { return max_ns / 1000.0; }
+    double mean_us() const { return samples ? total_ns / 1000.0 / samples : 0; }
+
+    std::string summary() const;  // "n=... p50=... p99=... p99.9=... max=... us"
+
+private:
+    static constexpr int SUB_BITS = 3;
+    static constexpr size_t BUCKETS = 64 << SUB_BITS;
+
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t samples = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    static size_t bucket_for(uint64_t ns);
+    static uint64_t bucket_upper(size_t bucket);
+};
+
+// Anonymous mapping backed by huge pages when available: explicit
+// MAP_HUGETLB first, then transparent huge pages, then normal pages.
+class HugePageBuffer {
+public:
+    HugePageBuffer() = default;
+    HugePageBuffer(size_t bytes, bool huge_pages);
+    ~HugePageBuffer();
+    HugePageBuffer(HugePageBuffer&& other) noexcept
+        : memory(std::exchange(other.memory, nullptr)), bytes(std::exchange(other.bytes, 0)),
+          huge(other.huge) {}
+    HugePageBuffer& operator=(HugePageBuffer&&) = delete;
+    HugePageBuffer(const HugePageBuffer&) = delete;
+
+    void* data() const { return memory; }
+    size_t size() const { return bytes; }
+    bool is_huge() const { return huge; }
+
+private:
+    void* memory = nullptr;
+    size_t bytes = 0;
+    bool huge = false;
+};
+
+// Bounded lock-free SPSC queue. Slots live in a (huge-page) buffer; each
+// item is stamped on push so the consumer can measure handoff latency.
+template <typename T>
+class SpscQueue {
+public:
+    SpscQueue(size_t capacity_pow2, bool huge_pages)
+        : mask(capacity_pow2 - 1),
+          storage(sizeof(Slot) * capacity_pow2, huge_pages),
+          slots(static_cast<Slot*>(storage.data())) {
+        if (capacity_pow2 == 0 || (capacity_pow2 & mask) != 0) {
+            throw std::invalid_argument("SpscQueue capacity must be a power of two");
+        }
+    }
+    ~SpscQueue() {
+        T ignored;
+        while (try_pop(ignored)) {}
+    }
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side; false when full
+    bool try_push(T value) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        Slot& slot = slots[t & mask];
+        new (&slot.value) T(std::move(value));
+        slot.enqueued = realtime::clock::now();
+        tail.store(t + 1, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+        return true;
+    }
+
+    // Consumer side
+    bool try_pop(T& out, realtime::clock::time_point* enqueued = nullptr) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        Slot& slot = slots[h & mask];
+        T* value = std::launder(reinterpret_cast<T*>(&slot.value));
+        out = std::move(*value);
+        if (enqueued) *enqueued = slot.enqueued;
+        value->~T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Block (futex wait or spin) until an item arrives or `stop` is set
+    bool pop_wait(T& out, const std::atomic<bool>& stop, bool busy_poll, JitterStats* handoff = nullptr) {
+        realtime::clock::time_point enqueued;
+        for (;;) {
+            uint32_t seen = signal.load(std::memory_order_acquire);
+            if (try_pop(out, &enqueued)) break;
+            if (stop.load(std::memory_order_relaxed)) return false;
+            if (busy_poll) realtime::cpu_relax();
+            else signal.wait(seen, std::memory_order_acquire);
+        }
+        if (handoff) handoff->record(realtime::clock::now() - enqueued);
+        return true;
+    }
+
+    // Wake a consumer blocked in pop_wait (used at shutdown)
+    void wake() {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char value[sizeof(T)];
+        realtime::clock::time_point enqueued;
+    };
+
+    const size_t mask;
+    HugePageBuffer storage;
+    Slot* slots;
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<uint32_t> signal{0};  // Bumped by push/wake; blocking consumers futex-wait on it
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/*
+ * RATE-LIMIT-AWARE REQUEST SCHEDULER
+ *
+ * Kraken limits are decay counters, not fixed windows:
+ * - Private REST calls add 1 (ledger/trade history: 2) to an API counter that
+ *   decays at a tier-dependent rate. Going over the max means a lockout.
+ * - Order placement/cancellation uses a separate per-pair matching engine
+ *   counter. Cancelling a young order costs more than an old one.
+ * - Public endpoints are throttled per IP (~1 call/s with a small burst).
+ *
+ * All KrakenAPI traffic goes through one dispatcher thread which:
+ * - Serves order/cancel traffic before account queries before market data
+ * - Never dispatches a call that would push a counter past its headroom,
+ *   and rejects one whose cost could never fit
+ * - Coalesces duplicate ticker requests onto one pending future
+ * - Batches queued ticker requests into a single multi-pair Ticker call
+ * - Charges ledger/trade-history queries 2, and cancels the age-dependent
+ *   cancel_cost() of the order (it remembers when each AddOrder txid was
+ *   placed; unknown txids keep the caller's cost)
+ *
+ * The dispatcher only admits calls. They run on two execution lanes:
+ * - private: orders first, then account queries, one call at a time so
+ *   nonces reach Kraken in the order they were issued
+ * - public: market data
+ * A slow Ticker or Depth call therefore never holds up an order.
+ *
+ * The transport is injected, so a local rate-limited mock can stand in for
+ * the exchange. A client with its own transport (AsyncKrakenAPI) asks
+ * admit() instead: it is charged to the same counters, behind queued work
+ * of higher priority, and its private calls hold the private lane until
+ * release().
+ */
+
+enum class RequestPriority {
+    Order = 0,       // AddOrder / CancelOrder / close_position
+    Account = 1,     // Balance / OpenPositions / TradeBalance
+    MarketData = 2   // Ticker / Depth / AssetPairs
+};
+
+enum class RateLimitTier {
+    Starter,
+    Intermediate,
+    Pro
+};
+
+// Kraken-style decay counter (a token bucket counted upwards)
+class DecayCounter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    DecayCounter(double max_count = 15, double decay_per_sec = 0.33);
+
+    // Seconds until a call of this cost fits under the limit (0 = now)
+    double wait_seconds(double cost, clock::time_point now);
+    void consume(double cost, clock::time_point now);
+    // Exchange said we are over: assume the counter is full
+    void saturate(clock::time_point now);
+
+    double level(clock::time_point now);
+    double max_count() const { return max; }
+
+private:
+    double max;
+    double decay_rate;
+    double count = 0;
+    clock::time_point last_update;
+
+    void decay(clock::time_point now);
+};
+
+struct RateLimitConfig {
+    double api_counter_max = 15;       // Private REST counter
+    double api_decay_per_sec = 0.33;
+    double order_counter_max = 60;     // Per-pair matching engine counter
+    double order_decay_per_sec = 1.0;
+    double public_counter_max = 3;     // Per-IP public endpoint burst
+    double public_decay_per_sec = 1.0;
+    double headroom = 0.9;             // Never fill counters past 90%
+    size_t max_ticker_batch = 50;      // Pairs per multi-pair Ticker call
+
+    static RateLimitConfig for_tier(RateLimitTier tier);
+};
+
+struct ApiRequest {
+    std::string endpoint;      // e.g. "/0/private/AddOrder"
+    json params = json::object();
+    bool is_private = false;
+    RequestPriority priority = RequestPriority::MarketData;
+    double cost = 1.0;         // Counter cost (API or order counter)
+    std::string pair;          // Order counter key for order traffic
+};
+
+struct SchedulerStats {
+    uint64_t dispatched = 0;
+    uint64_t ticker_batches = 0;
+    uint64_t ticker_pairs_batched = 0;
+    uint64_t coalesced = 0;
+    uint64_t rate_limit_errors = 0;
+    double total_wait_seconds = 0;
+};
+
+class RequestScheduler {
+public:
+    // Performs the actual HTTP round-trip and returns Kraken's "result" object
+    using Transport = std::function<json(const std::string& endpoint,
+                                         const json& params, bool is_private)>;
+
+    RequestScheduler(Transport transport,
+                     const RateLimitConfig& config = RateLimitConfig::for_tier(RateLimitTier::Starter));
+    ~RequestScheduler();
+
+    // Queue any call; the future resolves with the "result" object
+    std::shared_future<json> submit(ApiRequest request);
+
+    // Ticker for one pair - coalesced with pending duplicates, batched on dispatch
+    std::shared_future<json> ticker(const std::string& pair);
+
+    // Blocking convenience wrapper
+    json call(ApiRequest request) { return submit(std::move(request)).get(); }
+
+    // For callers that send `request` themselves. Returns 0 once it has been
+    // charged - a private one then holds the private lane, so send it (and
+    // take its nonce) now and release() it when the response is in - or the
+    // seconds to wait before asking again. Throws if the cost can never fit.
+    double admit(ApiRequest& request);
+    void release(const ApiRequest& request, const json& result);
+    void release(const ApiRequest& request, const std::exception& error);
+
+    // Response key for a requested pair name (Ticker answers with Kraken's
+    // internal names, e.g. "XBT/USD" -> "XXBTZUSD"); filled from AssetPairs
+    void set_pair_aliases(const std::map<std::string, std::string>& aliases);
+
+    // Replace the transport with a wrapped one (session capture/replay).
+    // Call before any request is submitted.
+    void wrap_transport(const std::function<Transport(Transport)>& wrapper);
+
+    // Run the counters `scale` x faster than wall time (accelerated replay).
+    // Resets counter levels - call before any request is submitted.
+    void set_time_scale(double scale);
+
+    // This process is one of `processes` sharing the API key and IP: keep
+    // 1/processes of the API and public budgets (decay rate and burst; a
+    // burst never drops below one call). Per-pair order counters are left
+    // whole. Resets counter levels - call before any request is submitted.
+    void share_limits(uint32_t processes);
+
+    // Order counter cost of cancelling an order that has lived this long
+    static double cancel_cost(double order_age_seconds);
+
+    // Current level of the counter `request` would be charged to (monitoring)
+    double counter_level(const ApiRequest& request);
+
+    SchedulerStats get_stats() const;
+    void stop();
+
+private:
+    struct Pending {
+        ApiRequest request;
+        std::promise<json> promise;
+        std::shared_future<json> future;
+    };
+
+    struct PendingTicker {
+        std::promise<json> promise;
+        std::shared_future<json> future;
+    };
+
+    // One admitted call, or one Ticker batch
+    struct Job {
+        std::optional<Pending> request;
+        std::vector<std::pair<std::string, PendingTicker>> tickers;
+    };
+
+    // Execution thread; the dispatcher only hands it work while it is idle,
+    // so queued work keeps its priority order until the last moment
+    struct Lane {
+        std::deque<Job> jobs;
+        std::condition_variable cv;
+        std::thread thread;
+        bool busy = false;
+    };
+    static constexpr int PRIVATE_LANE = 0;
+    static constexpr int PUBLIC_LANE = 1;
+
+    struct PlacedOrder {
+        std::string pair;
+        std::chrono::steady_clock::time_point placed;
+    };
+
+    std::shared_ptr<const Transport> transport;  // Lanes take a snapshot under the lock
+    RateLimitConfig config;
+    double time_scale = 1.0;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool running = true;
+    std::thread dispatcher;
+    Lane lanes[2];
+
+    // One FIFO per priority class
+    std::deque<Pending> queues[3];
+    // Queued ticker requests keyed by pair, in arrival order
+    std::map<std::string, PendingTicker> pending_tickers;
+    std::deque<std::string> ticker_order;
+    std::map<std::string, std::string> pair_aliases;
+
+    DecayCounter api_counter;
+    DecayCounter public_counter;
+    std::map<std::string, DecayCounter> order_counters;
+    std::map<std::string, PlacedOrder> placed_orders;  // txid -> pair / time, for cancel costs
+
+    SchedulerStats stats;
+
+    void dispatch_loop();
+    void lane_loop(int lane);
+    DecayCounter& counter_for(const ApiRequest& request);
+    void apply_costs(ApiRequest& request);
+    void remember_orders(const ApiRequest& request, const json& result);
+    void execute(Pending& pending, const Transport& send);
+    void execute_ticker_batch(std::vector<std::pair<std::string, PendingTicker>>& batch, const Transport& send);
+    void on_transport_error(const std::exception& e, DecayCounter& counter);
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include "request_scheduler.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * SESSION CAPTURE AND REPLAY
+ *
+ * Capture wraps the scheduler's transport and appends every exchange
+ * (request, result or error, start time, latency) to a binary log:
+ *
+ *   [FileHeader][Record]...[Record]
+ *   Record = RecordHeader + endpoint + CBOR params + (CBOR result | error text)
+ *
+ * Each record is flushed as it completes, so a crashed session is still
+ * readable up to its last exchange.
+ *
+ * Replay turns a log back into a transport. Requests are matched per
+ * endpoint in recorded order: the first pending record with identical
+ * params wins, otherwise the next one. Each answer is held until its
+ * recorded completion time divided by the speed-up. The same bot code
+ * then sees the same responses in the same order, only faster.
+ *
+ * Both are held by shared_ptr; the transports they hand out keep them
+ * alive for as long as the scheduler does.
+ *
+ * API keys and signatures never reach the log - the transport only sees
+ * endpoint and params.
+ */
+
+namespace session_format {
+    constexpr uint32_t FILE_MAGIC = 0x5345534B;  // "KSES"
+    constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic = FILE_MAGIC;
+        uint32_t version = VERSION;
+        int64_t started_wall_us = 0;  // system_clock at capture start
+    };
+
+    struct RecordHeader {
+        int64_t start_us = 0;         // Since capture start (steady clock)
+        uint32_t latency_us = 0;
+        uint8_t is_private = 0;
+        uint8_t is_error = 0;
+        uint16_t endpoint_len = 0;
+        uint32_t params_len = 0;
+        uint32_t body_len = 0;
+    };
+}
+
+struct RecordedExchange {
+    int64_t start_us = 0;
+    uint32_t latency_us = 0;
+    bool is_private = false;
+    bool is_error = false;
+    std::string endpoint;
+    json params;
+    json result;          // When !is_error
+    std::string error;    // When is_error
+};
+
+class SessionRecorder : public std::enable_shared_from_this<SessionRecorder> {
+public:
+    explicit SessionRecorder(const std::string& path);
+    ~SessionRecorder();
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Transport that forwards to `inner` and logs the exchange
+    RequestScheduler::Transport wrap(RequestScheduler::Transport inner);
+
+    uint64_t exchanges() const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    mutable std::mutex mutex;
+    std::FILE* file = nullptr;
+    clock::time_point started;
+    uint64_t recorded = 0;
+
+    void append(const RecordedExchange& exchange);
+};
+
+// Thrown once the log has no answer left for a request
+class ReplayExhausted : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class SessionReplayer : public std::enable_shared_from_this<SessionReplayer> {
+public:
+    // speed: 10 = ten times real time, 0 = no pacing at all
+    explicit SessionReplayer(const std::string& path, double speed = 10.0);
+
+    RequestScheduler::Transport transport();
+
+    double speed() const { return replay_speed; }
+    size_t total() const { return exchanges.size(); }
+    size_t remaining() const;
+
+    static std::vector<RecordedExchange> load(const std::string& path);
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // How far ahead a request may match a record with identical params
+    static constexpr size_t MATCH_WINDOW = 64;
+
+    std::vector<RecordedExchange> exchanges;
+    std::map<std::string, std::deque<size_t>> pending_by_endpoint;
+    double replay_speed;
+    bool started = false;
+    clock::time_point replay_start;
+    mutable std::mutex mutex;
+
+    json answer(const std::string& endpoint, const json& params);
+};
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "instrument.hpp"
+#include "learning_engine.hpp"
+#include "portfolio.hpp"
+#include "request_scheduler.hpp"
+
+class StatsPublisher;
+
+/*
+ * PAIR-SHARDED MULTI-PROCESS MODE
+ *
+ * `kraken_bot --shards N` starts a coordinator, which spawns N worker
+ * processes. Worker K trades only the pairs that hash to K (shard_of),
+ * and it has its own KrakenAPI session, ticker feed, order books,
+ * decision logic and LearningEngine. Scanning and learning therefore
+ * scale with processes and cores, not with one loop.
+ *
+ * All workers use the same API key, so they share its limits:
+ * - each worker's scheduler gets 1/N of the private API counter and the
+ *   per-IP public budget (RequestScheduler::share_limits). The per-pair
+ *   order counters stay whole, because a pair lives in exactly one shard
+ * - private calls take a lock in the segment (serialize_private), so
+ *   nonces reach Kraken in the order they were issued across processes
+ * On SIGINT/SIGTERM a worker closes its position, saves its trade log and
+ * exits; the coordinator keeps serving the rings until every worker is
+ * gone.
+ *
+ * The coordinator owns what must stay account-wide:
+ * - one PortfolioEngine with the account equity and RiskLimits. Every
+ *   entry is approved there. An approval books the quoted size as a
+ *   reservation until the worker reports the real fill (or releases it),
+ *   so two shards can never both take the last position slot or the
+ *   last of an asset's exposure
+ * - a merged LearningEngine that receives every shard's closed trades.
+ *   It holds the account-wide pattern statistics, regime and trade log,
+ *   and it feeds the main live-stats segment. Pattern keys start with
+ *   the pair and a pair never changes shard, so workers never need
+ *   another shard's patterns to decide
+ *
+ * The transport is one POSIX shared memory segment
+ * (/dev/shm/kraken_bot_shards). It holds, per worker, two fixed-size
+ * SPSC rings: worker -> coordinator for requests and events, and
+ * coordinator -> worker for verdicts. It also holds an account block
+ * that the coordinator republishes after every batch (equity, day P&L,
+ * entry gate, circuit breaker, heartbeat). Workers read the gate and the
+ * breaker straight from that block, so only entry approvals need a round
+ * trip. Messages are trivially copyable and fixed-size, so a socket
+ * transport between hosts could carry them unchanged.
+ *
+ * If the coordinator stops heartbeating, workers stop opening positions
+ * (RiskVerdict::Unreachable) but keep managing the ones they hold.
+ */
+
+namespace shard_layout {
+    constexpr uint32_t MAGIC = 0x4448534B;  // "KSHD"
+    constexpr uint32_t VERSION = 2;
+    constexpr uint32_t MAX_SHARDS = 64;
+    constexpr size_t RING_CAPACITY = 1024;  // Messages per direction per worker (power of two)
+}
+
+// Stable pair -> shard assignment (FNV-1a of the pair name)
+uint32_t shard_of(std::string_view pair, uint32_t shards);
+
+enum class ShardMessageKind : uint8_t {
+    Entry,        // -> coordinator: approve (and reserve) an entry
+    Verdict,      // -> worker: answer to Entry
+    Release,      // -> coordinator: an approved entry did not fill
+    Fill,         // -> coordinator: executed order
+    Mark,         // -> coordinator: new mark for an open position
+    Fee,
+    TradeClosed,  // -> coordinator: round trip finished (loss streak, stats)
+    Trade         // -> coordinator: the trade for the merged learning engine
+};
+
+struct ShardMessage {
+    ShardMessageKind kind = ShardMessageKind::Entry;
+    Side side = Side::Buy;
+    RiskVerdict verdict = RiskVerdict::Allowed;
+    bool settles_reservation = false;  // Fill: replaces the pair's approved reservation
+    uint32_t id = 0;                   // Entry <-> Verdict
+    int32_t pair_decimals = 0;         // Entry / Fill carry the pair's precision
+    int32_t lot_decimals = 0;
+    Symbol pair;
+    Symbol base;
+    Price price;
+    Qty qty;
+    Notional amount;                   // Fee, closed P&L, or a mark's unrealized P&L
+    double leverage = 1.0;
+    TradeRecord trade{};               // Trade only
+};
+
+// Lock-free SPSC ring living in the shared segment; head/tail are only
+// touched through std::atomic_ref
+struct ShardRing {
+    alignas(64) uint64_t head = 0;
+    alignas(64) uint64_t tail = 0;
+    ShardMessage messages[shard_layout::RING_CAPACITY];
+
+    bool try_push(const ShardMessage& message);
+    bool try_pop(ShardMessage& out);
+};
+
+// Republished by the coordinator; every field is read independently
+struct ShardAccount {
+    int64_t equity = 0;              // Notional raw
+    int64_t daily_pnl = 0;
+    int64_t drawdown = 0;            // Intraday, from the day's peak
+    int64_t cooldown_until_us = 0;   // system_clock
+    int64_t heartbeat_us = 0;        // steady_clock
+    uint32_t open_positions = 0;
+    uint32_t gate = 0;               // RiskVerdict of entry_gate()
+    uint32_t halted = 0;             // Daily loss breaker tripped
+    uint32_t coordinator_pid = 0;
+};
+
+struct ShardLane {
+    alignas(64) uint32_t worker_pid = 0;
+    ShardRing to_coordinator;
+    ShardRing to_worker;
+};
+
+struct ShardHeader {
+    uint32_t magic = shard_layout::MAGIC;
+    uint32_t version = shard_layout::VERSION;
+    uint32_t shards = 0;
+    uint32_t lane_size = sizeof(ShardLane);
+    alignas(64) ShardAccount account;
+    alignas(64) uint32_t private_call_owner = 0;  // pid holding the key's private-call lock
+    // `shards` ShardLanes follow, each at a 64-byte boundary
+};
+
+// Coordinator side - creates the segment, owns account risk and the
+// merged learning engine. Single-threaded.
+class ShardCoordinator {
+public:
+    ShardCoordinator(std::string segment, uint32_t shards, Notional starting_equity, RiskLimits limits);
+    ~ShardCoordinator();  // Unlinks the segment
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    // Drain every worker's ring, then republish the account block;
+    // returns the number of messages handled
+    size_t poll();
+    // Account block + heartbeat (poll() does this; call it when idle too)
+    void publish();
+
+    // Merged trades and positions also go to the live stats segment
+    void set_stats_publisher(StatsPublisher* publisher);
+
+    uint32_t shards() const { return shard_count; }
+    const std::string& segment_name() const { return name; }
+    const PortfolioEngine& portfolio() const { return account; }
+    LearningEngine& learning() { return merged; }
+    uint64_t approvals() const { return approved; }
+    uint64_t rejections() const { return rejected; }
+    uint64_t trades() const { return merged_trades; }
+
+private:
+    struct Reservation {
+        Side side = Side::Buy;
+        Price price;
+        Qty qty;
+        double leverage = 1.0;
+    };
+
+    std::string name;
+    uint32_t shard_count;
+    void* memory = nullptr;
+    size_t bytes = 0;
+    ShardHeader* header = nullptr;
+
+    PortfolioEngine account;
+    LearningEngine merged;
+    StatsPublisher* stats = nullptr;
+    std::unordered_map<Symbol, std::unique_ptr<InstrumentSpec>> specs;  // Stable for the portfolio's slots
+    std::unordered_map<Symbol, Reservation> reservations;
+    uint64_t approved = 0;
+    uint64_t rejected = 0;
+    uint64_t merged_trades = 0;
+
+    ShardLane& lane(uint32_t shard);
+    void handle(ShardLane& lane, const ShardMessage& message);
+    const InstrumentSpec& spec_for(const ShardMessage& message);
+    void release(PortfolioEngine::PairSlot slot, const Symbol& pair);
+};
+
+// Worker side - the execution path's line to the coordinator. Not
+// thread-safe: one thread (the execution thread when threaded) sends.
+class ShardLink {
+public:
+    ShardLink(std::string segment, uint32_t shard,
+              std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+    ~ShardLink();
+    ShardLink(const ShardLink&) = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    uint32_t shard() const { return index; }
+    uint32_t shards() const { return header->shards; }
+    bool owns(std::string_view pair) const { return shard_of(pair, header->shards) == index; }
+
+    // Account gate / breaker from the shared block - no round trip. Any
+    // thread may read these.
+    RiskVerdict entry_gate() const;
+    bool halted() const;
+    Notional account_equity() const;
+    Notional account_daily_pnl() const;
+    Notional account_drawdown() const;
+
+    // Round trip to the account PortfolioEngine. Allowed reserves the
+    // size; report the fill with settles_reservation, or release().
+    RiskVerdict check(const InstrumentSpec& spec, Side side, Price price, Qty volume, double leverage);
+    void release(const InstrumentSpec& spec);
+
+    void on_fill(const InstrumentSpec& spec, Side side, Price price, Qty volume, double leverage,
+                 bool settles_reservation = false);
+    void on_mark(const Symbol& pair, Price mark, Qty size, Notional unrealized_pnl);  // Dropped if the ring is full
+    void charge_fee(Notional fee);
+    void on_trade_closed(const Symbol& pair, Notional net_pnl);
+    void record_trade(const TradeRecord& trade);
+
+    // Wraps a KrakenAPI transport: private calls run one at a time across
+    // all workers (nonce order); a lock left by a dead worker is taken over
+    RequestScheduler::Transport serialize_private(RequestScheduler::Transport inner);
+
+private:
+    std::string name;
+    uint32_t index;
+    std::chrono::milliseconds timeout;
+    void* memory = nullptr;
+    size_t bytes = 0;
+    ShardHeader* header = nullptr;
+    ShardLane* lane = nullptr;
+    uint32_t next_id = 0;
+
+    bool send(const ShardMessage& message, bool may_drop = false);
+    static ShardMessage for_pair(ShardMessageKind kind, const InstrumentSpec& spec);
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "instrument.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * LIVE STATS IN SHARED MEMORY (SEQLOCK)
+ *
+ * The bot publishes positions, P&L, pattern stats, latency histograms
+ * and the market regime into one fixed-layout POSIX shared memory
+ * segment (/dev/shm/kraken_bot_stats on Linux). Every update is O(1).
+ *
+ * Writers are serialised by a std::mutex inside StatsPublisher, so the
+ * write side is not lock-free: in threaded mode all four bot threads
+ * publish, and one that finds the mutex held blocks (a futex syscall)
+ * until the other's short update is done.
+ * Single-threaded, the mutex is never contended and an update makes no
+ * syscall.
+ *
+ * Readers are lock-free. The sequence counter is odd while a write is in
+ * progress; a reader copies the whole segment and retries if the counter
+ * was odd or moved during the copy. Readers never slow the writer down.
+ *
+ * The layout is little-endian with explicit offsets (see the
+ * static_asserts in stats_shm.cpp), so non-C++ readers such as
+ * server.js's /api/bot-stats can decode it straight from the file.
+ */
+
+namespace stats_layout {
+    constexpr uint32_t MAGIC = 0x5453424B;  // "KBST"
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t MAX_POSITIONS = 16;
+    constexpr size_t MAX_PATTERNS = 64;     // Further patterns are not exported
+    constexpr size_t LATENCY_BUCKETS = 32;  // Bucket i: [2^i, 2^(i+1)) ns
+}
+
+enum class LatencyKind : uint32_t {
+    Order = 0,       // place_market_order round trip
+    MarketData = 1,  // Batched ticker fetch
+    Decision = 2,    // Scan -> chosen pair
+    Count
+};
+
+const char* to_string(LatencyKind kind);
+
+struct ShmPosition {
+    char pair[24] = {};           // Empty = free slot
+    int64_t size_lots = 0;
+    int64_t entry_ticks = 0;
+    int64_t mark_ticks = 0;
+    int64_t unrealized_pnl = 0;   // Notional raw (1e-8 USD)
+    double leverage = 1.0;
+    int32_t pair_decimals = 0;
+    int32_t lot_decimals = 0;
+    int64_t opened_us = 0;
+};
+
+struct ShmPattern {
+    char key[32] = {};            // "PAIR_2x_1" as in the learning engine
+    uint32_t trades = 0;
+    uint32_t wins = 0;
+    int64_t pnl = 0;              // Notional raw
+    double roi_sum = 0;           // Readers derive mean / std dev / Sharpe
+    double roi_sq_sum = 0;
+    int64_t last_trade_us = 0;
+    int64_t reserved = 0;
+};
+
+struct ShmLatency {
+    char name[16] = {};
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t buckets[stats_layout::LATENCY_BUCKETS] = {};
+};
+
+struct StatsSegment {
+    uint32_t magic = stats_layout::MAGIC;
+    uint32_t version = stats_layout::VERSION;
+    alignas(8) uint64_t sequence = 0;  // Seqlock; only touched via std::atomic_ref
+    uint32_t layout_size = sizeof(StatsSegment);
+    uint32_t pid = 0;
+    int64_t started_us = 0;
+    int64_t updated_us = 0;
+
+    // Session
+    uint64_t trades = 0;
+    uint64_t wins = 0;
+    int64_t session_pnl = 0;      // Notional raw
+    int64_t peak_pnl = 0;
+    int64_t max_drawdown = 0;     // Largest peak-to-trough drop of session_pnl
+    char regime[16] = {};
+    uint32_t open_positions = 0;
+    uint32_t pattern_count = 0;
+
+    ShmPosition positions[stats_layout::MAX_POSITIONS];
+    ShmPattern patterns[stats_layout::MAX_PATTERNS];
+    ShmLatency latency[static_cast<size_t>(LatencyKind::Count)];
+};
+
+// Writer side - owned by the bot. Several threads publish, so writes take a
+// mutex; readers stay lock-free on the seqlock.
+class StatsPublisher {
+public:
+    explicit StatsPublisher(std::string name = "/kraken_bot_stats");
+    ~StatsPublisher();  // Unlinks the segment
+    StatsPublisher(const StatsPublisher&) = delete;
+    StatsPublisher& operator=(const StatsPublisher&) = delete;
+
+    void on_trade(std::string_view pattern_key, Notional net_pnl, double roi, std::string_view regime);
+    void on_position_open(const InstrumentSpec& spec, Price entry, Qty size, double leverage);
+    void on_mark(const Symbol& pair, Price mark, Qty size, Notional unrealized_pnl);
+    void on_position_closed(const Symbol& pair);
+    void record_latency(LatencyKind kind, std::chrono::nanoseconds elapsed);
+
+    const std::string& segment_name() const { return name; }
+
+private:
+    std::string name;
+    StatsSegment* segment = nullptr;
+    std::mutex writer;  // Threaded bot: every thread publishes
+    std::unordered_map<std::string, uint32_t> pattern_slots;
+    std::unordered_map<Symbol, uint32_t> position_slots;
+
+    // RAII write section: sequence odd on entry, even again on exit
+    class Write {
+    public:
+        explicit Write(StatsSegment* s);
+        ~Write();
+    private:
+        StatsSegment* segment;
+        uint64_t start;
+    };
+};
+
+// Reader side - for the CLI or any other local process
+class StatsReader {
+public:
+    explicit StatsReader(std::string name = "/kraken_bot_stats");
+    ~StatsReader();
+    StatsReader(const StatsReader&) = delete;
+    StatsReader& operator=(const StatsReader&) = delete;
+
+    // Consistent copy of the segment; false if the writer never let go
+    bool read(StatsSegment& out, int max_attempts = 10000) const;
+
+    static json to_json(const StatsSegment& stats);
+
+private:
+    const StatsSegment* segment = nullptr;
+};
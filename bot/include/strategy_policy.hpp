@@ -0,0 +1,221 @@
+#pragma once
+
+#include <concepts>
+#include <tuple>
+#include <utility>
+#include "fixed_point.hpp"
+#include "learning_engine.hpp"
+
+/*
+ * COMPILE-TIME STRATEGY POLICIES
+ *
+ * Entry filters, exit rules and sizing rules are small value types checked
+ * by concepts and composed with EntryChain / ExitChain. A policy's
+ * thresholds are fixed when the position opens, so a per-tick check is a
+ * few inlined integer compares. It never re-reads StrategyConfig.
+ *
+ * with_exit_policy() maps a StrategyConfig onto one of the common
+ * instantiated shapes (TP/SL with/without trailing stop and partial exit)
+ * and calls the hold loop with it. Learned configs that fit none of them
+ * fall back to RuntimeExitRule, which branches on the config every tick.
+ */
+
+// ---------------------------------------------------------------------------
+// Inputs
+// ---------------------------------------------------------------------------
+
+struct EntrySnapshot {
+    double volatility_pct;
+    double spread_pct;
+};
+
+struct TickState {
+    Notional pnl;            // Trade P&L so far: banked partials + open remainder
+    Notional peak;           // Best pnl so far
+    bool partial_taken = false;
+};
+
+enum class ExitAction : uint8_t {
+    Hold,
+    PartialExit,   // Sell part, keep holding the rest
+    Exit
+};
+
+struct ExitSignal {
+    ExitAction action = ExitAction::Hold;
+    ExitReason reason = ExitReason::Timeout;
+};
+
+// ---------------------------------------------------------------------------
+// Concepts
+// ---------------------------------------------------------------------------
+
+template <typename F>
+concept EntryFilter = requires(const F f, const EntrySnapshot& s) {
+    { f.allows(s) } -> std::same_as<bool>;
+};
+
+template <typename R>
+concept ExitRule = requires(const R r, const TickState& s) {
+    { r.check(s) } -> std::same_as<ExitSignal>;
+};
+
+template <typename S>
+concept SizingRule = requires(const S s, const EntrySnapshot& e) {
+    { s.size_for(e) } -> std::same_as<Notional>;
+};
+
+// ---------------------------------------------------------------------------
+// Entry filters
+// ---------------------------------------------------------------------------
+
+struct MinVolatility {
+    double min_pct;
+    bool allows(const EntrySnapshot& s) const { return s.volatility_pct >= min_pct; }
+};
+
+struct MaxSpread {
+    double max_pct;
+    bool allows(const EntrySnapshot& s) const { return s.spread_pct <= max_pct; }
+};
+
+template <EntryFilter... Filters>
+struct EntryChain {
+    std::tuple<Filters...> filters;
+
+    bool allows(const EntrySnapshot& s) const {
+        return std::apply([&](const auto&... f) { return (f.allows(s) && ...); }, filters);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Exit rules
+// ---------------------------------------------------------------------------
+
+struct TakeProfit {
+    Notional target;
+    ExitSignal check(const TickState& s) const {
+        if (s.pnl > target) return {ExitAction::Exit, ExitReason::TakeProfit};
+        return {};
+    }
+};
+
+struct StopLoss {
+    Notional limit;  // Negative
+    ExitSignal check(const TickState& s) const {
+        if (s.pnl < limit) return {ExitAction::Exit, ExitReason::StopLoss};
+        return {};
+    }
+};
+
+// Armed once in profit; exits when giving back `distance` from the peak
+struct TrailingStop {
+    Notional distance;
+    ExitSignal check(const TickState& s) const {
+        if (s.peak.raw > 0 && s.pnl < s.peak - distance) {
+            return {ExitAction::Exit, ExitReason::TrailingStop};
+        }
+        return {};
+    }
+};
+
+// Bank part of the position halfway to the take-profit target
+struct PartialTakeProfit {
+    Notional target;
+    ExitSignal check(const TickState& s) const {
+        if (!s.partial_taken && s.pnl > target) return {ExitAction::PartialExit, ExitReason::TakeProfit};
+        return {};
+    }
+};
+
+// First rule that fires wins, in declaration order
+template <ExitRule... Rules>
+struct ExitChain {
+    std::tuple<Rules...> rules;
+
+    ExitSignal check(const TickState& s) const {
+        ExitSignal out;
+        std::apply([&](const auto&... r) {
+            ((out.action == ExitAction::Hold ? (out = r.check(s), 0) : 0), ...);
+        }, rules);
+        return out;
+    }
+};
+
+// Fallback: the original behaviour, re-reading StrategyConfig every tick
+struct RuntimeExitRule {
+    const StrategyConfig* config;
+    double position_size_usd;
+
+    ExitSignal check(const TickState& s) const {
+        double pnl = s.pnl.to_double();
+        if (config->use_partial_exits && !s.partial_taken && config->take_profit_pct > 0 &&
+            pnl > position_size_usd * config->take_profit_pct * 0.5) {
+            return {ExitAction::PartialExit, ExitReason::TakeProfit};
+        }
+        if (config->take_profit_pct > 0 && pnl > position_size_usd * config->take_profit_pct) {
+            return {ExitAction::Exit, ExitReason::TakeProfit};
+        }
+        if (config->stop_loss_pct > 0 && pnl < -(position_size_usd * config->stop_loss_pct)) {
+            return {ExitAction::Exit, ExitReason::StopLoss};
+        }
+        if (config->use_trailing_stop && config->trailing_stop_pct > 0 && s.peak.raw > 0 &&
+            pnl < s.peak.to_double() - position_size_usd * config->trailing_stop_pct / 100.0) {
+            return {ExitAction::Exit, ExitReason::TrailingStop};
+        }
+        return {};
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Sizing rules
+// ---------------------------------------------------------------------------
+
+struct FixedNotionalSize {
+    Notional size;
+    Notional size_for(const EntrySnapshot&) const { return size; }
+};
+
+// ---------------------------------------------------------------------------
+// Policies
+// ---------------------------------------------------------------------------
+
+template <EntryFilter Entry, ExitRule Exit, SizingRule Sizing>
+struct StrategyPolicy {
+    Entry entry;
+    Exit exit;
+    Sizing sizing;
+};
+
+// The shapes learned and default configs actually take
+using TpSlExit = ExitChain<TakeProfit, StopLoss>;
+using TpSlTrailingExit = ExitChain<TakeProfit, StopLoss, TrailingStop>;
+using TpSlPartialExit = ExitChain<PartialTakeProfit, TakeProfit, StopLoss>;
+using FullExit = ExitChain<PartialTakeProfit, TakeProfit, StopLoss, TrailingStop>;
+
+// Call f(exit_rule) with the specialised exit rule for this config. The
+// hold loop written against `auto&` is instantiated once per shape.
+template <typename F>
+decltype(auto) with_exit_policy(const StrategyConfig& config, double position_size_usd, F&& f) {
+    bool fixed_shape = config.take_profit_pct > 0 && config.stop_loss_pct > 0 &&
+                       (!config.use_trailing_stop || config.trailing_stop_pct > 0);
+    if (!fixed_shape) {
+        return f(RuntimeExitRule{&config, position_size_usd});
+    }
+
+    Notional tp = Notional::from_double(position_size_usd * config.take_profit_pct);
+    Notional sl = -Notional::from_double(position_size_usd * config.stop_loss_pct);
+    Notional trail = Notional::from_double(position_size_usd * config.trailing_stop_pct / 100.0);
+    Notional partial = Notional::from_double(position_size_usd * config.take_profit_pct * 0.5);
+
+    if (config.use_partial_exits && config.use_trailing_stop) {
+        return f(FullExit{{PartialTakeProfit{partial}, TakeProfit{tp}, StopLoss{sl}, TrailingStop{trail}}});
+    }
+    if (config.use_partial_exits) {
+        return f(TpSlPartialExit{{PartialTakeProfit{partial}, TakeProfit{tp}, StopLoss{sl}}});
+    }
+    if (config.use_trailing_stop) {
+        return f(TpSlTrailingExit{{TakeProfit{tp}, StopLoss{sl}, TrailingStop{trail}}});
+    }
+    return f(TpSlExit{{TakeProfit{tp}, StopLoss{sl}}});
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include "instrument.hpp"
+
+using json = nlohmann::json;
+
+/*
+ * COMPRESSED COLUMNAR TICK HISTORY
+ *
+ * Every ticker / book update is a row (timestamp, kind, price, qty) in
+ * fixed-point ticks/lots. Rows go to one segment file per pair per UTC day:
+ *
+ *   <dir>/<PAIR>/<YYYYMMDD>[-n].seg
+ *
+ *   [FileHeader][Block]...[Block][IndexEntry x N][Footer]
+ *
+ * A block holds up to block_rows rows, or block_span of time, whichever
+ * comes first, one column after another:
+ * - timestamp: zigzag varint delta from the previous row (first in header)
+ * - kind:      raw byte
+ * - price:     zigzag varint delta from the previous row
+ * - qty:       zigzag varint
+ *
+ * The trailing sparse index (first/last timestamp + offset per block)
+ * lets a reader mmap the file and jump straight to a time range. A
+ * segment cut short by a crash has no footer. Readers then rebuild the
+ * index by walking the self-describing block headers.
+ *
+ * Writers only hold a file open while writing a block, so hundreds of
+ * pairs never pin hundreds of descriptors. A write failure is reported
+ * and drops that pair's segment; the next row starts a new one.
+ */
+
+enum class TickKind : uint8_t {
+    Last = 0,
+    Bid = 1,
+    Ask = 2,
+    BookBid = 3,   // L2 level update (qty 0 = level removed)
+    BookAsk = 4
+};
+
+struct Tick {
+    int64_t timestamp_us = 0;
+    TickKind kind = TickKind::Last;
+    Price price;
+    Qty qty;
+};
+
+// One decoded block, columnar; rows [begin, end) fall inside the query range
+struct TickBatch {
+    std::vector<int64_t> timestamp_us;
+    std::vector<uint8_t> kind;
+    std::vector<int64_t> price;
+    std::vector<int64_t> qty;
+    size_t begin = 0;
+    size_t end = 0;
+
+    size_t size() const { return end - begin; }
+};
+
+namespace tick_format {
+    constexpr uint32_t FILE_MAGIC = 0x3153544B;    // "KTS1"
+    constexpr uint32_t BLOCK_MAGIC = 0x314B4C42;   // "BLK1"
+    constexpr uint32_t FOOTER_MAGIC = 0x5849544B;  // "KTIX"
+    constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic = FILE_MAGIC;
+        uint32_t version = VERSION;
+        char pair[24] = {};
+        int32_t day = 0;             // YYYYMMDD (UTC)
+        int32_t pair_decimals = 0;
+        int32_t lot_decimals = 0;
+        uint32_t reserved = 0;
+    };
+
+    struct BlockHeader {
+        uint32_t magic = BLOCK_MAGIC;
+        uint32_t rows = 0;
+        int64_t first_ts = 0;
+        int64_t last_ts = 0;
+        uint32_t ts_bytes = 0;
+        uint32_t kind_bytes = 0;
+        uint32_t price_bytes = 0;
+        uint32_t qty_bytes = 0;
+    };
+
+    struct IndexEntry {
+        int64_t first_ts = 0;
+        int64_t last_ts = 0;
+        uint64_t offset = 0;
+        uint32_t rows = 0;
+        uint32_t reserved = 0;
+    };
+
+    struct Footer {
+        uint64_t index_offset = 0;
+        uint32_t block_count = 0;
+        uint32_t magic = FOOTER_MAGIC;
+    };
+
+    int32_t utc_day(int64_t timestamp_us);  // -> YYYYMMDD
+}
+
+// Write methods throw std::runtime_error on I/O failure; the writer is
+// unusable afterwards
+class SegmentWriter {
+public:
+    SegmentWriter(const std::string& path, const InstrumentSpec& spec, int32_t day, size_t block_rows = 4096,
+                  int64_t block_span_us = 60'000'000);
+    ~SegmentWriter();  // close(); failures are reported, never thrown
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+    void append(const Tick& tick);
+    void flush();   // Encode and write the pending block
+    void close();   // flush + sparse index + footer
+
+    // The pending block started block_span ago or more
+    bool due(int64_t now_us) const { return !pending.empty() && now_us - pending.front().timestamp_us >= block_span_us; }
+
+    int32_t day() const { return segment_day; }
+    uint64_t rows_written() const { return total_rows; }
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;  // Open only inside flush() / close()
+    int32_t segment_day;
+    size_t block_rows;
+    int64_t block_span_us;
+    uint64_t offset = 0;
+    uint64_t total_rows = 0;
+    bool finished = false;
+    bool failed = false;
+
+    std::vector<Tick> pending;
+    std::vector<uint8_t> ts_col, kind_col, price_col, qty_col;
+    std::vector<tick_format::IndexEntry> index;
+
+    void open_file();
+    void close_file();
+    void write(const void* data, size_t len);
+};
+
+// I/O failures never reach the caller: they are counted, reported on
+// stderr and the pair starts a fresh segment. Malformed ticker / book
+// JSON still throws.
+class TickRecorder {
+public:
+    explicit TickRecorder(std::string directory, size_t block_rows = 4096,
+                          std::chrono::seconds block_span = std::chrono::seconds(60));
+    ~TickRecorder();
+
+    void record(const InstrumentSpec& spec, const Tick& tick);
+    // Kraken REST/WS ticker: bid ("b"), ask ("a") and last trade ("c")
+    void record_ticker(const InstrumentSpec& spec, const json& ticker, int64_t timestamp_us);
+    void record_book(const InstrumentSpec& spec, Side side, Price price, Qty qty, int64_t timestamp_us);
+    // REST Depth snapshot ({"asks": [[price, volume, ts], ...], "bids": ...}) as book rows
+    void record_depth(const InstrumentSpec& spec, const json& depth, int64_t timestamp_us);
+
+    void flush();
+    void flush_due(int64_t now_us);  // Blocks open for block_span or longer (quiet pairs)
+    void close();
+
+    uint64_t write_errors() const { return errors; }
+
+    static std::string pair_directory(const std::string& directory, const Symbol& pair);
+
+private:
+    std::string directory;
+    size_t block_rows;
+    int64_t block_span_us;
+    uint64_t errors = 0;
+    std::unordered_map<Symbol, std::unique_ptr<SegmentWriter>> writers;
+
+    SegmentWriter& writer_for(const InstrumentSpec& spec, int32_t day);
+    void report(const Symbol& pair, const std::exception& error);
+};
+
+class SegmentReader {
+public:
+    explicit SegmentReader(const std::string& path);
+    ~SegmentReader();
+    SegmentReader(const SegmentReader&) = delete;
+    SegmentReader& operator=(const SegmentReader&) = delete;
+
+    const tick_format::FileHeader& header() const { return *file_header; }
+    size_t block_count() const { return index.size(); }
+    uint64_t row_count() const;
+    int64_t first_timestamp() const { return index.empty() ? 0 : index.front().first_ts; }
+    int64_t last_timestamp() const { return index.empty() ? 0 : index.back().last_ts; }
+
+    void decode_block(size_t block, TickBatch& out) const;
+
+    // Stream [from_us, to_us) as decoded batches; returns rows delivered
+    template <typename F>
+    uint64_t scan(int64_t from_us, int64_t to_us, F&& on_batch) const;
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    const tick_format::FileHeader* file_header = nullptr;
+    std::vector<tick_format::IndexEntry> index;
+
+    void rebuild_index();
+};
+
+// All segments of one pair under a recorder directory
+class TickHistory {
+public:
+    explicit TickHistory(std::string directory) : directory(std::move(directory)) {}
+
+    std::vector<std::string> segments(const Symbol& pair, int64_t from_us, int64_t to_us) const;
+
+    template <typename F>
+    uint64_t scan(const Symbol& pair, int64_t from_us, int64_t to_us, F&& on_batch) const {
+        uint64_t rows = 0;
+        for (const auto& path : segments(pair, from_us, to_us)) {
+            SegmentReader reader(path);
+            rows += reader.scan(from_us, to_us, on_batch);
+        }
+        return rows;
+    }
+
+private:
+    std::string directory;
+};
+
+template <typename F>
+uint64_t SegmentReader::scan(int64_t from_us, int64_t to_us, F&& on_batch) const {
+    // First block that can still contain from_us
+    size_t lo = 0, hi = index.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (index[mid].last_ts < from_us) lo = mid + 1;
+        else hi = mid;
+    }
+
+    uint64_t delivered = 0;
+    TickBatch batch;
+    for (size_t b = lo; b < index.size() && index[b].first_ts < to_us; b++) {
+        decode_block(b, batch);
+
+        size_t begin = 0, end = batch.timestamp_us.size();
+        if (index[b].first_ts < from_us) {
+            while (begin < end && batch.timestamp_us[begin] < from_us) begin++;
+        }
+        if (index[b].last_ts >= to_us) {
+            while (end > begin && batch.timestamp_us[end - 1] >= to_us) end--;
+        }
+        if (begin == end) continue;
+
+        batch.begin = begin;
+        batch.end = end;
+        delivered += end - begin;
+        on_batch(static_cast<const TickBatch&>(batch));
+    }
+    return delivered;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <ostream>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/*
+ * ALLOCATION-FREE TRADING TYPES
+ *
+ * Order / Position / TradeRecord are copied by value on every decision, so
+ * their members must not own heap memory:
+ * - FixedString<N>: inline, trivially copyable symbol / order-id storage
+ * - Side, OrderStatus, ExitReason: one-byte enums instead of strings
+ *
+ * Strings only appear at the edges (JSON, logging) via to_string / to_json.
+ */
+
+template <size_t Capacity>
+class FixedString {
+public:
+    static_assert(Capacity > 0 && Capacity < 256, "length is stored in one byte");
+
+    constexpr FixedString() = default;
+    FixedString(const char* s) { assign(std::string_view(s)); }
+    FixedString(std::string_view s) { assign(s); }
+    FixedString(const std::string& s) { assign(std::string_view(s)); }
+
+    void assign(std::string_view s) {
+        if (s.size() > Capacity) {
+            throw std::length_error("FixedString: '" + std::string(s) + "' exceeds " +
+                                    std::to_string(Capacity) + " chars");
+        }
+        std::memcpy(data_, s.data(), s.size());
+        data_[s.size()] = '\0';
+        size_ = static_cast<uint8_t>(s.size());
+    }
+
+    const char* c_str() const { return data_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    operator std::string_view() const { return view(); }
+    std::string str() const { return std::string(data_, size_); }
+
+    friend bool operator==(const FixedString& a, const FixedString& b) { return a.view() == b.view(); }
+    friend bool operator==(const FixedString& a, std::string_view b) { return a.view() == b; }
+    friend bool operator==(const FixedString& a, const char* b) { return a.view() == b; }
+    friend bool operator==(const FixedString& a, const std::string& b) { return a.view() == b; }
+    friend auto operator<=>(const FixedString& a, const FixedString& b) { return a.view() <=> b.view(); }
+    friend auto operator<=>(const FixedString& a, std::string_view b) { return a.view() <=> b; }
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedString& s) { return os << s.view(); }
+
+private:
+    char data_[Capacity + 1] = {};
+    uint8_t size_ = 0;
+};
+
+using Symbol = FixedString<23>;   // "XBT/USD", "XXBTZUSD", wsnames
+using OrderId = FixedString<31>;  // Kraken txids are 19 chars ("OQCLML-BW3P3-BUCMWZ")
+
+template <size_t Capacity>
+void to_json(json& j, const FixedString<Capacity>& s) { j = s.str(); }
+
+template <size_t Capacity>
+void from_json(const json& j, FixedString<Capacity>& s) { s.assign(j.get<std::string>()); }
+
+namespace std {
+template <size_t Capacity>
+struct hash<FixedString<Capacity>> {
+    size_t operator()(const FixedString<Capacity>& s) const noexcept {
+        return hash<string_view>{}(s.view());
+    }
+};
+}
+
+enum class Side : uint8_t {
+    Buy,
+    Sell
+};
+
+enum class OrderStatus : uint8_t {
+    Pending,
+    Filled,
+    Cancelled
+};
+
+enum class ExitReason : uint8_t {
+    TakeProfit,
+    StopLoss,
+    TrailingStop,
+    Timeout,
+    Manual
+};
+
+// Wire names match the strings the bot and Kraken have always used
+inline const char* to_string(Side side) {
+    return side == Side::Buy ? "buy" : "sell";
+}
+
+inline const char* to_string(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::Pending: return "pending";
+        case OrderStatus::Filled: return "filled";
+        case OrderStatus::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+inline const char* to_string(ExitReason reason) {
+    switch (reason) {
+        case ExitReason::TakeProfit: return "take_profit";
+        case ExitReason::StopLoss: return "stop_loss";
+        case ExitReason::TrailingStop: return "trailing_stop";
+        case ExitReason::Timeout: return "timeout";
+        case ExitReason::Manual: return "manual";
+    }
+    return "unknown";
+}
+
+inline Side parse_side(std::string_view s) {
+    if (s == "buy") return Side::Buy;
+    if (s == "sell") return Side::Sell;
+    throw std::invalid_argument("Unknown side: " + std::string(s));
+}
+
+inline OrderStatus parse_order_status(std::string_view s) {
+    // Kraken reports "open"/"closed"/"canceled"/"expired"
+    if (s == "filled" || s == "closed") return OrderStatus::Filled;
+    if (s == "cancelled" || s == "canceled" || s == "expired") return OrderStatus::Cancelled;
+    return OrderStatus::Pending;
+}
+
+inline ExitReason parse_exit_reason(std::string_view s) {
+    if (s == "take_profit") return ExitReason::TakeProfit;
+    if (s == "stop_loss") return ExitReason::StopLoss;
+    if (s == "trailing_stop") return ExitReason::TrailingStop;
+    if (s == "timeout") return ExitReason::Timeout;
+    return ExitReason::Manual;
+}
+
+inline void to_json(json& j, Side v) { j = to_string(v); }
+inline void to_json(json& j, OrderStatus v) { j = to_string(v); }
+inline void to_json(json& j, ExitReason v) { j = to_string(v); }
+inline void from_json(const json& j, Side& v) { v = parse_side(j.get<std::string>()); }
+inline void from_json(const json& j, OrderStatus& v) { v = parse_order_status(j.get<std::string>()); }
+inline void from_json(const json& j, ExitReason& v) { v = parse_exit_reason(j.get<std::string>()); }
+
+inline std::ostream& operator<<(std::ostream& os, Side v) { return os << to_string(v); }
+inline std::ostream& operator<<(std::ostream& os, OrderStatus v) { return os << to_string(v); }
+inline std::ostream& operator<<(std::ostream& os, ExitReason v) { return os << to_string(v); }
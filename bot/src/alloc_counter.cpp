@@ -0,0 +1,59 @@
+#include "alloc_counter.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+void AllocationScope::expect_none(const char* path) const {
+    if (uint64_t n = count(); n != 0) {
+        std::cerr << "❌ " << n << " heap allocation(s) on the allocation-free path: " << path << std::endl;
+        std::abort();
+    }
+}
+
+#ifdef KRAKEN_COUNT_ALLOCATIONS
+
+namespace {
+    thread_local uint64_t thread_allocations = 0;
+
+    void* counted_alloc(std::size_t size) {
+        thread_allocations++;
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+
+    void* counted_aligned_alloc(std::size_t size, std::align_val_t align) {
+        thread_allocations++;
+        std::size_t alignment = static_cast<std::size_t>(align);
+        std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+        if (void* p = std::aligned_alloc(alignment, rounded ? rounded : alignment)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return counted_aligned_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_aligned_alloc(size, align); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace alloc_counter {
+    bool enabled() { return true; }
+    uint64_t allocations() { return thread_allocations; }
+}
+
+#else
+
+namespace alloc_counter {
+    bool enabled() { return false; }
+    uint64_t allocations() { return 0; }
+}
+
+#endif
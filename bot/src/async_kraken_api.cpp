@@ -0,0 +1,346 @@
+#include "async_kraken_api.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <iostream>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <openssl/evp.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+    std::string base64_encode(const unsigned char* data, size_t len) {
+        std::string out(4 * ((len + 2) / 3), '\0');
+        int n = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(out.data()), data, static_cast<int>(len));
+        out.resize(n);
+        return out;
+    }
+
+    std::string base64_decode(const std::string& in) {
+        std::string out(3 * in.size() / 4, '\0');
+        int n = EVP_DecodeBlock(reinterpret_cast<unsigned char*>(out.data()),
+                                reinterpret_cast<const unsigned char*>(in.data()), static_cast<int>(in.size()));
+        if (n < 0) throw std::runtime_error("Invalid base64 API secret");
+        // EVP_DecodeBlock counts padding bytes as output
+        size_t padding = 0;
+        for (auto it = in.rbegin(); it != in.rend() && *it == '='; ++it) padding++;
+        out.resize(n - padding);
+        return out;
+    }
+
+    // application/x-www-form-urlencoded, for query strings and POST bodies
+    std::string form_encode(const json& params) {
+        static constexpr char HEX[] = "0123456789ABCDEF";
+        std::string out;
+        for (const auto& [key, value] : params.items()) {
+            std::string text = value.is_string() ? value.get<std::string>() : value.dump();
+            if (!out.empty()) out += '&';
+            out += key + '=';
+            for (unsigned char c : text) {
+                if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+                    out += static_cast<char>(c);
+                } else {
+                    out += '%';
+                    out += HEX[c >> 4];
+                    out += HEX[c & 15];
+                }
+            }
+        }
+        return out;
+    }
+
+    // Releases an admitted call's budget hold on every path, including the
+    // task being destroyed mid-request
+    struct Admission {
+        RequestScheduler& scheduler;
+        const ApiRequest& request;
+        bool released = false;
+
+        ~Admission() {
+            if (!released) scheduler.release(request, std::runtime_error("Request abandoned"));
+        }
+        void succeeded(const json& result) {
+            released = true;
+            scheduler.release(request, result);
+        }
+        void failed(const std::exception& error) {
+            released = true;
+            scheduler.release(request, error);
+        }
+    };
+}
+
+AsyncKrakenAPI::AsyncKrakenAPI(EventLoop& loop, RequestScheduler& scheduler, bool paper_trading, std::string base_url)
+    : loop(loop), scheduler(scheduler), paper_mode(paper_trading), base_url(std::move(base_url)) {}
+
+bool AsyncKrakenAPI::authenticate() {
+    const char* key = std::getenv("KRAKEN_API_KEY");
+    const char* secret = std::getenv("KRAKEN_API_SECRET");
+    if (key) api_key = key;
+    if (secret) api_secret = secret;
+    // Paper mode only needs public market data
+    return paper_mode || (!api_key.empty() && !api_secret.empty());
+}
+
+std::string AsyncKrakenAPI::next_nonce() {
+    // Strictly increasing even when calls follow within the same microsecond
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    last_nonce = std::max(now, last_nonce + 1);
+    return std::to_string(last_nonce);
+}
+
+std::string AsyncKrakenAPI::sign(const std::string& path, const std::string& nonce,
+                                 const std::string& postdata) const {
+    // API-Sign = base64(HMAC-SHA512(path + SHA256(nonce + postdata), base64decode(secret)))
+    std::string inner = nonce + postdata;
+    unsigned char sha[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(inner.data()), inner.size(), sha);
+
+    std::string message = path + std::string(reinterpret_cast<char*>(sha), sizeof(sha));
+    std::string key = base64_decode(api_secret);
+
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_len = 0;
+    HMAC(EVP_sha512(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char*>(message.data()), message.size(), mac, &mac_len);
+    return base64_encode(mac, mac_len);
+}
+
+json AsyncKrakenAPI::unwrap(const HttpResponse& response, const std::string& method) {
+    if (response.status != 200) {
+        throw std::runtime_error(method + ": HTTP " + std::to_string(response.status));
+    }
+    json body = json::parse(response.body);
+    if (body.contains("error") && !body["error"].empty()) {
+        std::string errors;
+        for (const auto& e : body["error"]) errors += (errors.empty() ? "" : ", ") + e.get<std::string>();
+        throw std::runtime_error(method + ": " + errors);
+    }
+    return body["result"];
+}
+
+Task<json> AsyncKrakenAPI::public_call(std::string method, json params) {
+    ApiRequest request;
+    request.endpoint = "/0/public/" + method;
+    request.params = std::move(params);
+    co_return co_await call(std::move(request));
+}
+
+Task<json> AsyncKrakenAPI::private_call(std::string method, json params, RequestPriority priority, std::string pair) {
+    ApiRequest request;
+    request.endpoint = "/0/private/" + method;
+    request.params = std::move(params);
+    request.is_private = true;
+    request.priority = priority;
+    request.pair = std::move(pair);
+    co_return co_await call(std::move(request));
+}
+
+Task<json> AsyncKrakenAPI::call(ApiRequest request) {
+    for (double wait; (wait = scheduler.admit(request)) > 0;) {
+        co_await loop.sleep_for(std::chrono::duration_cast<EventLoop::clock::duration>(
+            std::chrono::duration<double>(wait)));
+    }
+    Admission admission{scheduler, request};
+
+    HttpRequest http;
+    if (request.is_private) {
+        http = signed_request(request);  // Nonce taken now, while the private lane is ours
+    } else {
+        std::string query = form_encode(request.params);
+        http.url = base_url + request.endpoint + (query.empty() ? "" : "?" + query);
+    }
+
+    try {
+        HttpResponse response = co_await loop.http(std::move(http));
+        json result = unwrap(response, request.endpoint);
+        admission.succeeded(result);
+        co_return result;
+    } catch (const std::exception& e) {
+        admission.failed(e);
+        throw;
+    }
+}
+
+HttpRequest AsyncKrakenAPI::signed_request(const ApiRequest& request) {
+    std::string nonce = next_nonce();
+    std::string params = form_encode(request.params);
+    std::string postdata = "nonce=" + nonce + (params.empty() ? "" : "&" + params);
+
+    HttpRequest http;
+    http.url = base_url + request.endpoint;
+    http.headers = {
+        "API-Key: " + api_key,
+        "API-Sign: " + sign(request.endpoint, nonce, postdata),
+        "Content-Type: application/x-www-form-urlencoded"
+    };
+    http.body = std::move(postdata);
+    return http;
+}
+
+Task<void> AsyncKrakenAPI::load_instruments() {
+    json result = co_await public_call("AssetPairs", json::object());
+    instruments.load_asset_pairs(result);
+    std::cout << "📐 Loaded precision for " << instruments.size() << " pairs" << std::endl;
+}
+
+Task<json> AsyncKrakenAPI::get_ticker(std::string pair) {
+    json params = {{"pair", pair}};
+    json result = co_await public_call("Ticker", std::move(params));
+    if (result.contains(pair)) co_return result[pair];
+    if (const InstrumentSpec* spec = instruments.find(pair); spec && result.contains(spec->pair.str())) {
+        co_return result[spec->pair.str()];
+    }
+    if (result.size() == 1) co_return result.begin().value();
+    throw std::runtime_error("Ticker: no data for " + pair);
+}
+
+Task<std::map<std::string, json>> AsyncKrakenAPI::get_tickers(std::vector<std::string> pairs) {
+    std::vector<Task<json>> batches;
+    for (size_t first = 0; first < pairs.size(); first += TICKER_BATCH) {
+        std::string list;
+        for (size_t i = first; i < std::min(first + TICKER_BATCH, pairs.size()); i++) {
+            list += (list.empty() ? "" : ",") + pairs[i];
+        }
+        json params = {{"pair", list}};
+        batches.push_back(public_call("Ticker", std::move(params)));
+    }
+    std::vector<json> results = co_await when_all(loop, std::move(batches));
+
+    // Kraken answers with its own pair keys; map them back to what was asked
+    std::map<std::string, json> tickers;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        const std::string& pair = pairs[i];
+        const json& result = results[i / TICKER_BATCH];
+        if (result.contains(pair)) {
+            tickers[pair] = result[pair];
+        } else if (const InstrumentSpec* spec = instruments.find(pair); spec && result.contains(spec->pair.str())) {
+            tickers[pair] = result[spec->pair.str()];
+        }
+    }
+    co_return tickers;
+}
+
+Task<Price> AsyncKrakenAPI::get_current_price(Symbol pair) {
+    json ticker = co_await get_ticker(pair.str());
+    co_return instruments.get(pair).parse_price(ticker["c"][0].get<std::string>());
+}
+
+Task<Notional> AsyncKrakenAPI::get_balance(std::string currency) {
+    if (paper_mode) co_return paper_balance;
+    json result = co_await private_call("Balance", json::object(), RequestPriority::Account);
+    // Kraken keys legacy fiat and crypto balances as ZUSD / XXBT
+    for (const std::string& key : {currency, "Z" + currency, "X" + currency}) {
+        if (result.contains(key)) co_return Notional::parse(result[key].get<std::string>());
+    }
+    co_return Notional{};
+}
+
+Task<std::vector<Position>> AsyncKrakenAPI::get_open_positions() {
+    std::vector<Position> positions;
+    if (paper_mode) {
+        for (const auto& [pair, position] : paper_positions) positions.push_back(position);
+        co_return positions;
+    }
+
+    json params = {{"docalcs", "true"}};
+    json result = co_await private_call("OpenPositions", std::move(params), RequestPriority::Account);
+    for (const auto& [id, p] : result.items()) {
+        const InstrumentSpec* spec = instruments.find(p["pair"].get<std::string>());
+        if (!spec) continue;
+
+        Position position;
+        position.pair = spec->pair;
+        position.size = spec->parse_qty(p["vol"].get<std::string>()) - spec->parse_qty(p["vol_closed"].get<std::string>());
+        double vol = std::stod(p["vol"].get<std::string>());
+        double cost = std::stod(p["cost"].get<std::string>());
+        double margin = std::stod(p.value("margin", "0"));
+        position.entry_price = spec->price_from_double(vol > 0 ? cost / vol : 0);
+        position.leverage = margin > 0 ? cost / margin : 1.0;
+        if (p.contains("value") && vol > 0) {
+            position.current_price = spec->price_from_double(std::stod(p["value"].get<std::string>()) / vol);
+        }
+        if (p.contains("net")) position.unrealized_pnl = Notional::parse(p["net"].get<std::string>());
+        positions.push_back(position);
+    }
+    co_return positions;
+}
+
+Task<Order> AsyncKrakenAPI::place_market_order(Symbol pair, Side side, Qty volume, double leverage) {
+    if (paper_mode) co_return co_await paper_fill(pair, side, volume, leverage);
+
+    const InstrumentSpec& spec = instruments.get(pair);
+    json params = {{"ordertype", "market"}, {"type", to_string(side)},
+                   {"volume", spec.format(volume).str()}, {"pair", spec.pair.str()}};
+    if (leverage > 1.0) params["leverage"] = std::to_string(static_cast<int>(leverage)) + ":1";
+
+    json added = co_await private_call("AddOrder", std::move(params), RequestPriority::Order, spec.pair.str());
+
+    Order order;
+    order.order_id = added["txid"][0].get<std::string>();
+    order.pair = spec.pair;
+    order.side = side;
+    order.volume = volume;
+
+    // Market orders fill almost immediately; poll without blocking the loop
+    for (int attempt = 0; attempt < 20; attempt++) {
+        json query = {{"txid", order.order_id.str()}};
+        json info = co_await private_call("QueryOrders", std::move(query), RequestPriority::Account);
+        const json& o = info[order.order_id.str()];
+        order.status = parse_order_status(o["status"].get<std::string>());
+        if (order.status != OrderStatus::Pending) {
+            order.filled = spec.parse_qty(o["vol_exec"].get<std::string>());
+            order.price = spec.parse_price(o["price"].get<std::string>());
+            break;
+        }
+        co_await loop.sleep_for(250ms);
+    }
+    co_return order;
+}
+
+Task<bool> AsyncKrakenAPI::cancel_order(OrderId order_id) {
+    if (paper_mode) co_return false;  // Paper market orders fill instantly
+    json params = {{"txid", order_id.str()}};
+    json result = co_await private_call("CancelOrder", std::move(params), RequestPriority::Order);
+    co_return result.value("count", 0) > 0;
+}
+
+Task<Order> AsyncKrakenAPI::paper_fill(Symbol pair, Side side, Qty volume, double leverage) {
+    const InstrumentSpec& spec = instruments.get(pair);
+    json ticker = co_await get_ticker(pair.str());
+
+    // Cross the spread like a real market order would
+    Price fill = spec.parse_price(ticker[side == Side::Buy ? "a" : "b"][0].get<std::string>());
+
+    Order order;
+    order.order_id = "PAPER-" + std::to_string(++paper_order_seq);
+    order.pair = spec.pair;
+    order.side = side;
+    order.price = fill;
+    order.volume = volume;
+    order.filled = volume;
+    order.status = OrderStatus::Filled;
+
+    Notional cost = spec.notional(fill, volume);
+    Position& position = paper_positions[spec.pair];
+    position.pair = spec.pair;
+    position.leverage = leverage;
+    position.current_price = fill;
+    if (side == Side::Buy) {
+        // Adding to a position: entry is the size-weighted average
+        __int128 held = position.size.lots;
+        __int128 total = held + volume.lots;
+        position.entry_price = Price{static_cast<int64_t>(fixed_point::div_round(
+            held * position.entry_price.ticks + static_cast<__int128>(volume.lots) * fill.ticks, total))};
+        position.size = position.size + volume;
+        paper_balance -= cost;
+    } else {
+        position.size = position.size - volume;
+        paper_balance += cost;
+        if (position.size.lots <= 0) paper_positions.erase(spec.pair);
+    }
+    co_return order;
+}
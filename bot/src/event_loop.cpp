@@ -0,0 +1,174 @@
+#include "event_loop.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+    struct CurlGlobal {
+        CurlGlobal() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+        ~CurlGlobal() { curl_global_cleanup(); }
+    };
+
+    struct PostAwaiter {
+        EventLoop* loop;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { loop->post(h); }
+        void await_resume() const noexcept {}
+    };
+}
+
+EventLoop::EventLoop(long max_host_connections) {
+    static CurlGlobal curl_global;
+    multi = curl_multi_init();
+    if (!multi) throw std::runtime_error("curl_multi_init failed");
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+}
+
+EventLoop::~EventLoop() {
+    // Nothing may resume a frame about to be destroyed
+    ready.clear();
+    timers = {};
+    // Destroying a spawned frame destroys the tasks it awaits, and their
+    // HttpAwaiters take their transfers off the multi handle
+    auto frames = std::exchange(detached, {});
+    for (void* frame : frames) std::coroutine_handle<>::from_address(frame).destroy();
+    curl_multi_cleanup(multi);
+}
+
+void EventLoop::spawn(Task<void> task) {
+    start_detached(*this, std::move(task));
+}
+
+EventLoop::Detached EventLoop::start_detached(EventLoop& loop, Task<void> task) {
+    // First step runs from the loop, never inline in spawn()
+    co_await PostAwaiter{&loop};
+    try {
+        co_await task;
+    } catch (const std::exception& e) {
+        std::cerr << "  ❌ Async task failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "  ❌ Async task failed" << std::endl;
+    }
+}
+
+void EventLoop::run() {
+    stopping = false;
+
+    while (!stopping) {
+        run_ready();
+        fire_timers();
+        if (stopping) break;
+
+        if (ready.empty() && timers.empty() && active_requests == 0) break;  // Idle
+
+        int timeout_ms = 0;
+        if (ready.empty()) {
+            timeout_ms = 1000;
+            if (!timers.empty()) {
+                auto until = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    timers.top().deadline - clock::now()).count();
+                timeout_ms = static_cast<int>(std::clamp<long long>(until, 0, 1000));
+            }
+        }
+        poll_network(timeout_ms);
+    }
+}
+
+void EventLoop::run_ready() {
+    // Only what is queued now; coroutines posted while running wait a turn
+    size_t n = ready.size();
+    for (size_t i = 0; i < n && !stopping; i++) {
+        auto h = ready.front();
+        ready.pop_front();
+        h.resume();
+    }
+}
+
+void EventLoop::fire_timers() {
+    auto now = clock::now();
+    while (!timers.empty() && timers.top().deadline <= now) {
+        ready.push_back(timers.top().handle);
+        timers.pop();
+    }
+}
+
+void EventLoop::poll_network(int timeout_ms) {
+    if (active_requests > 0 || timeout_ms > 0) {
+        curl_multi_poll(multi, nullptr, 0, timeout_ms, nullptr);
+    }
+
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+
+        HttpAwaiter* awaiter = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &awaiter);
+
+        if (msg->data.result == CURLE_OK) {
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &awaiter->response.status);
+        } else {
+            awaiter->error = awaiter->error_buffer[0] ? awaiter->error_buffer
+                                                       : curl_easy_strerror(msg->data.result);
+        }
+
+        curl_multi_remove_handle(multi, msg->easy_handle);
+        curl_easy_cleanup(msg->easy_handle);
+        curl_slist_free_all(awaiter->header_list);
+        awaiter->easy = nullptr;
+        awaiter->header_list = nullptr;
+        active_requests--;
+
+        ready.push_back(awaiter->waiting);
+    }
+}
+
+size_t EventLoop::write_callback(char* data, size_t size, size_t nmemb, void* userdata) {
+    static_cast<std::string*>(userdata)->append(data, size * nmemb);
+    return size * nmemb;
+}
+
+void EventLoop::HttpAwaiter::await_suspend(std::coroutine_handle<> h) {
+    waiting = h;
+    easy = curl_easy_init();
+    if (!easy) {
+        error = "curl_easy_init failed";
+        loop->post(h);
+        return;
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &EventLoop::write_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, this);
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, error_buffer);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, request.timeout_ms);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+
+    if (!request.body.empty()) {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+    }
+    for (const auto& header : request.headers) {
+        header_list = curl_slist_append(header_list, header.c_str());
+    }
+    if (header_list) curl_easy_setopt(easy, CURLOPT_HTTPHEADER, header_list);
+
+    curl_multi_add_handle(loop->multi, easy);
+    loop->active_requests++;
+}
+
+EventLoop::HttpAwaiter::~HttpAwaiter() {
+    if (!easy) return;
+    curl_multi_remove_handle(loop->multi, easy);
+    curl_easy_cleanup(easy);
+    curl_slist_free_all(header_list);
+    loop->active_requests--;
+}
+
+HttpResponse EventLoop::HttpAwaiter::await_resume() {
+    if (!error.empty()) throw std::runtime_error("HTTP " + request.url + ": " + error);
+    return std::move(response);
+}
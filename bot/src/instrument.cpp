@@ -0,0 +1,60 @@
+#include "instrument.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+void InstrumentRegistry::load_asset_pairs(const json& asset_pairs) {
+    specs.clear();
+    index.clear();
+    specs.reserve(asset_pairs.size());
+
+    for (const auto& [key, info] : asset_pairs.items()) {
+        if (key.size() > Symbol::capacity()) continue;
+
+        InstrumentSpec spec;
+        spec.pair = key;
+        if (info.contains("base") && info["base"].is_string()) {
+            std::string base = info["base"].get<std::string>();
+            if (base.size() <= Symbol::capacity()) spec.base = base;
+        }
+        spec.pair_decimals = info.value("pair_decimals", 5);
+        spec.lot_decimals = info.value("lot_decimals", 8);
+        spec.cost_decimals = info.value("cost_decimals", 5);
+        if (spec.pair_decimals + spec.lot_decimals > 18) continue;  // Past int64 range
+        if (info.contains("ordermin") && info["ordermin"].is_string()) {
+            spec.ordermin = spec.parse_qty(info["ordermin"].get<std::string>());
+        }
+
+        size_t slot = specs.size();
+        specs.push_back(spec);
+        index[key] = slot;
+        if (info.contains("altname")) index.emplace(info["altname"].get<std::string>(), slot);
+        if (info.contains("wsname")) index.emplace(info["wsname"].get<std::string>(), slot);
+    }
+}
+
+bool InstrumentRegistry::load_from_file(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.good()) {
+        std::cerr << "Cannot load file: " << filepath << std::endl;
+        return false;
+    }
+
+    json data;
+    file >> data;
+    load_asset_pairs(data.contains("result") ? data["result"] : data);
+
+    std::cout << "📐 Loaded precision for " << specs.size() << " pairs from " << filepath << std::endl;
+    return true;
+}
+
+const InstrumentSpec* InstrumentRegistry::find(std::string_view pair) const {
+    auto it = index.find(pair);
+    return it == index.end() ? nullptr : &specs[it->second];
+}
+
+const InstrumentSpec& InstrumentRegistry::get(std::string_view pair) const {
+    const InstrumentSpec* spec = find(pair);
+    if (!spec) throw std::out_of_range("No AssetPairs precision for " + std::string(pair));
+    return *spec;
+}
@@ -1,4 +1,5 @@
 #include "learning_engine.hpp"
+#include "stats_shm.hpp"
 #include <numeric>
 #include <fstream>
 #include <iostream>
@@ -6,13 +7,39 @@
 #include <cmath>
 #include <set>
 
-LearningEngine::LearningEngine() {}
+LearningEngine::LearningEngine() {
+    // Traded until a pair has a validated strategy (cold start included)
+    safe_default.name = "safe_default";
+    safe_default.leverage = 1.0;
+    safe_default.timeframe_seconds = 60;
+    safe_default.take_profit_pct = 0.02;
+    safe_default.stop_loss_pct = 0.03;
+    safe_default.position_size_usd = 50;
+}
 
 LearningEngine::~LearningEngine() {}
 
 void LearningEngine::record_trade(const TradeRecord& trade) {
     trade_history.push_back(trade);
-    trades_by_pair[trade.pair].push_back(trade);
+    trades_by_pair[trade.pair.str()].push_back(trade);
+    
+    running_pnl += trade.pnl;
+    if (trade.is_win()) running_wins++;
+    
+    double roi = trade.roi();
+    recent_rois.push_back(roi);
+    recent_roi_sum += roi;
+    recent_roi_sq_sum += roi * roi;
+    if (recent_rois.size() > REGIME_LOOKBACK) {
+        recent_roi_sum -= recent_rois.front();
+        recent_roi_sq_sum -= recent_rois.front() * recent_rois.front();
+        recent_rois.pop_front();
+    }
+    
+    if (stats_publisher) {
+        std::string key = generate_pattern_key(trade.pair.str(), trade.leverage, timeframe_bucket(trade.timeframe_seconds));
+        stats_publisher->on_trade(key, Notional::from_double(trade.pnl), roi, detect_market_regime());
+    }
     
     // Auto-analyze every 25 trades
     if (trade_history.size() % 25 == 0) {
@@ -22,7 +49,7 @@ void LearningEngine::record_trade(const TradeRecord& trade) {
 }
 
 void LearningEngine::analyze_patterns() {
-    if (trade_history.size() < MIN_TRADES_FOR_ANALYSIS) {
+    if (trade_history.size() < static_cast<size_t>(MIN_TRADES_FOR_ANALYSIS)) {
         std::cout << "⏳ Need " << MIN_TRADES_FOR_ANALYSIS << " trades for analysis (have " 
                   << trade_history.size() << ")" << std::endl;
         return;
@@ -33,13 +60,7 @@ void LearningEngine::analyze_patterns() {
     // 1. GROUP TRADES BY PATTERN
     std::map<std::string, std::vector<TradeRecord>> patterns;
     for (const auto& trade : trade_history) {
-        int timeframe_bucket;
-        if (trade.timeframe_seconds < 30) timeframe_bucket = 0;
-        else if (trade.timeframe_seconds < 60) timeframe_bucket = 1;
-        else if (trade.timeframe_seconds < 120) timeframe_bucket = 2;
-        else timeframe_bucket = 3;
-        
-        std::string key = generate_pattern_key(trade.pair, trade.leverage, timeframe_bucket);
+        std::string key = generate_pattern_key(trade.pair.str(), trade.leverage, timeframe_bucket(trade.timeframe_seconds));
         patterns[key].push_back(trade);
     }
     
@@ -96,7 +117,7 @@ void LearningEngine::analyze_patterns() {
         double expected_pnl = (metrics.win_rate * metrics.avg_win) + 
                             ((1.0 - metrics.win_rate) * -metrics.avg_loss);
         metrics.has_edge = expected_pnl > metrics.total_fees * 1.5;  // Must beat fees
-        metrics.edge_percentage = (expected_pnl / metrics.avg_win) * 100 if metrics.avg_win > 0 else 0;
+        metrics.edge_percentage = metrics.avg_win > 0 ? (expected_pnl / metrics.avg_win) * 100 : 0;
         
         pattern_database[pattern_key] = metrics;
         
@@ -129,6 +150,13 @@ std::string LearningEngine::generate_pattern_key(const std::string& pair, double
     return pair + "_" + std::to_string((int)leverage) + "x_" + std::to_string(timeframe);
 }
 
+int LearningEngine::timeframe_bucket(int timeframe_seconds) {
+    if (timeframe_seconds < 30) return 0;
+    if (timeframe_seconds < 60) return 1;
+    if (timeframe_seconds < 120) return 2;
+    return 3;
+}
+
 void LearningEngine::identify_winning_patterns() {
     std::cout << "\n🏆 WINNING PATTERNS:" << std::endl;
     
@@ -240,18 +268,12 @@ void LearningEngine::detect_regime_shifts() {
 }
 
 std::string LearningEngine::detect_market_regime() const {
-    if (trade_history.empty()) return "unknown";
-    
-    // Measure recent volatility and direction
-    std::vector<double> recent_returns;
-    int lookback = std::min(20, (int)trade_history.size());
+    if (recent_rois.empty()) return "unknown";
     
-    for (int i = trade_history.size() - lookback; i < (int)trade_history.size(); i++) {
-        recent_returns.push_back(trade_history[i].roi());
-    }
-    
-    double avg_return = std::accumulate(recent_returns.begin(), recent_returns.end(), 0.0) / recent_returns.size();
-    double volatility = calculate_std_dev(recent_returns);
+    // Recent volatility and direction from the rolling window sums
+    double n = recent_rois.size();
+    double avg_return = recent_roi_sum / n;
+    double volatility = std::sqrt(std::max(0.0, recent_roi_sq_sum / n - avg_return * avg_return));
     
     if (volatility > 5.0) return "high_volatility";
     if (avg_return > 2.0) return "trending_up";
@@ -283,38 +305,75 @@ void LearningEngine::update_strategy_database() {
         strategy_configs.push_back(config);
     }
     
+    rebuild_strategy_index();
+    
     std::cout << "  ✅ Created " << strategy_configs.size() << " validated strategies" << std::endl;
 }
 
 StrategyConfig LearningEngine::get_optimal_strategy(const std::string& pair, double current_volatility) {
-    // Filter candidates
-    std::vector<StrategyConfig> candidates;
-    
-    for (const auto& config : strategy_configs) {
-        if (config.name.find(pair) == 0 && current_volatility >= config.min_volatility) {
-            candidates.push_back(config);
-        }
+    if (const StrategyConfig* best = lookup_strategy(pair_slot(pair), current_volatility)) {
+        return *best;
     }
-    
-    if (candidates.empty()) {
-        // Return safe default
-        StrategyConfig safe;
-        safe.name = "safe_default";
-        safe.leverage = 1.0;
-        safe.timeframe_seconds = 60;
-        safe.take_profit_pct = 0.02;
-        safe.stop_loss_pct = 0.03;
-        safe.position_size_usd = 50;
-        return safe;
+    return safe_default;
+}
+
+LearningEngine::PairSlot LearningEngine::pair_slot(const std::string& pair) {
+    auto [it, inserted] = pair_slots.try_emplace(pair, static_cast<PairSlot>(pair_slots.size()));
+    if (inserted) strategy_index_ranges.emplace_back(0, 0);  // No strategies until the next rebuild
+    return it->second;
+}
+
+void LearningEngine::get_optimal_strategies(const std::vector<PairSlot>& slots, const std::vector<double>& volatilities,
+                                            std::vector<const StrategyConfig*>& out) const {
+    out.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        const StrategyConfig* best = lookup_strategy(slots[i], volatilities[i]);
+        out[i] = best ? best : &safe_default;
+    }
+}
+
+const StrategyConfig* LearningEngine::lookup_strategy(PairSlot slot, double current_volatility) const {
+    if (slot >= strategy_index_ranges.size()) return nullptr;
+    auto [begin, end] = strategy_index_ranges[slot];
+    if (begin == end) return nullptr;
+    
+    // Entries whose threshold is <= current volatility are a prefix of the range
+    auto first = strategy_index.begin() + begin;
+    auto last = std::upper_bound(first, strategy_index.begin() + end, current_volatility,
+        [](double vol, const StrategyIndexEntry& e) { return vol < e.min_volatility; });
+    if (last == first) return nullptr;
+    return &strategy_configs[(last - 1)->best_config];
+}
+
+void LearningEngine::rebuild_strategy_index() {
+    // Group strategy configs by pair
+    std::unordered_map<std::string, std::vector<uint32_t>> by_pair;
+    for (uint32_t i = 0; i < strategy_configs.size(); i++) {
+        by_pair[pattern_database.at(strategy_configs[i].name).pair].push_back(i);
     }
     
-    // Return best (highest Sharpe ratio)
-    return *std::max_element(candidates.begin(), candidates.end(),
-        [](const auto& a, const auto& b) {
-            const auto& ma = pattern_database.at(a.name);
-            const auto& mb = pattern_database.at(b.name);
-            return ma.sharpe_ratio < mb.sharpe_ratio;
+    strategy_index.clear();
+    strategy_index.reserve(strategy_configs.size());
+    for (auto& range : strategy_index_ranges) range = {0, 0};
+    
+    for (auto& [pair, configs] : by_pair) {
+        std::sort(configs.begin(), configs.end(), [this](uint32_t a, uint32_t b) {
+            return strategy_configs[a].min_volatility < strategy_configs[b].min_volatility;
         });
+        
+        uint32_t begin = static_cast<uint32_t>(strategy_index.size());
+        uint32_t best = configs.front();
+        double best_sharpe = pattern_database.at(strategy_configs[best].name).sharpe_ratio;
+        for (uint32_t config : configs) {
+            double sharpe = pattern_database.at(strategy_configs[config].name).sharpe_ratio;
+            if (sharpe > best_sharpe) {
+                best = config;
+                best_sharpe = sharpe;
+            }
+            strategy_index.push_back({strategy_configs[config].min_volatility, best});
+        }
+        strategy_index_ranges[pair_slot(pair)] = {begin, static_cast<uint32_t>(strategy_index.size())};
+    }
 }
 
 PatternMetrics LearningEngine::get_pattern_metrics(const std::string& pair, double leverage, int timeframe_bucket) const {
@@ -427,15 +486,8 @@ json LearningEngine::get_statistics_json() const {
     stats["patterns_found"] = pattern_database.size();
     stats["strategies"] = strategy_configs.size();
     
-    double total_pnl = 0;
-    int wins = 0;
-    for (const auto& t : trade_history) {
-        total_pnl += t.pnl;
-        if (t.is_win()) wins++;
-    }
-    
-    stats["total_pnl"] = total_pnl;
-    stats["win_rate"] = trade_history.empty() ? 0 : (double)wins / trade_history.size();
+    stats["total_pnl"] = running_pnl;
+    stats["win_rate"] = trade_history.empty() ? 0 : (double)running_wins / trade_history.size();
     stats["regime"] = detect_market_regime();
     
     return stats;
@@ -449,7 +501,7 @@ void LearningEngine::print_summary() const {
     auto stats = get_statistics_json();
     std::cout << "  Total Trades: " << stats["total_trades"] << std::endl;
     std::cout << "  Win Rate: " << std::fixed << std::setprecision(1) 
-              << stats["win_rate"] * 100 << "%" << std::endl;
+              << stats["win_rate"].get<double>() * 100 << "%" << std::endl;
     std::cout << "  Total P&L: $" << std::setprecision(2) << stats["total_pnl"] << std::endl;
     std::cout << "  Patterns Found: " << stats["patterns_found"] << std::endl;
     std::cout << "  Validated Strategies: " << stats["strategies"] << std::endl;
@@ -4,8 +4,26 @@
 #include <chrono>
 #include <cstring>
 #include <cstdlib>
+#include <optional>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <csignal>
+#include <spawn.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "kraken_api.hpp"
+#include "async_kraken_api.hpp"
 #include "learning_engine.hpp"
+#include "alloc_counter.hpp"
+#include "strategy_policy.hpp"
+#include "tick_store.hpp"
+#include "stats_shm.hpp"
+#include "realtime.hpp"
+#include "portfolio.hpp"
+#include "order_book.hpp"
+#include "shard.hpp"
 
 using namespace std::chrono_literals;
 
@@ -18,17 +36,117 @@ struct BotConfig {
     int max_concurrent_trades = 1;
     double target_leverage = 2.0;
     double position_size_usd = 100;
+    bool record_ticks = true;             // Columnar tick history for backtests
+    std::string tick_history_dir = "tick_history";
+    bool publish_stats = true;            // Live stats segment for dashboards
+    std::string stats_segment = "/kraken_bot_stats";
+    std::string capture_file;             // Record all REST traffic here
+    std::string replay_file;              // Serve REST traffic from this capture
+    double replay_speed = 10.0;           // x real time; 0 = as fast as possible
+    bool threaded = false;                // Feed/strategy/execution/analytics threads
+    int feed_cpu = -1;                    // CPU pins (-1 = leave it to the OS)
+    int strategy_cpu = -1;
+    int execution_cpu = -1;
+    int analytics_cpu = -1;
+    bool busy_poll = false;               // Feed/execution spin instead of sleeping
+    bool lock_memory = false;             // mlockall before trading
+    bool huge_pages = false;              // Huge-page backed thread queues
+    int feed_interval_ms = 1000;          // Ticker poll period when threaded
+    bool async_feed = false;              // Ticker batches in flight together (AsyncKrakenAPI)
+    double max_daily_loss_usd = 500;      // Circuit breaker, resets at UTC midnight
+    int max_consecutive_losses = 3;       // Losing streak that triggers a cooldown
+    int loss_cooldown_seconds = 300;
+    double max_asset_exposure_usd = 1000; // Leverage-weighted, per base asset
+    double max_gross_leverage = 3.0;      // Gross exposure / equity
+    int book_depth = 100;                 // L2 levels kept per pair
+    double max_slippage_bps = 25;         // Skip entries the book can't absorb
+    int shards = 0;                       // > 0: coordinator + this many pair-sharded workers
+    int worker = -1;                      // This process is shard worker K
+    std::string shard_segment = "/kraken_bot_shards";
 };
 
+static RiskLimits risk_limits(const BotConfig& config) {
+    RiskLimits limits;
+    limits.max_daily_loss = Notional::from_double(config.max_daily_loss_usd);
+    limits.max_consecutive_losses = config.max_consecutive_losses;
+    limits.loss_cooldown = std::chrono::seconds(config.loss_cooldown_seconds);
+    limits.max_positions = static_cast<size_t>(config.max_concurrent_trades);
+    limits.max_asset_exposure = Notional::from_double(config.max_asset_exposure_usd);
+    limits.max_gross_leverage = config.max_gross_leverage;
+    return limits;
+}
+
+namespace {
+    // SIGINT/SIGTERM: the coordinator stops its workers; a bot (or worker)
+    // closes its position and returns from run(), so its logs and tick
+    // segments are saved on the way out
+    volatile std::sig_atomic_t stop_requested = 0;
+    void request_stop(int) { stop_requested = 1; }
+}
+
 class KrakenTradingBot {
 public:
     KrakenTradingBot(const BotConfig& config) : config(config) {
         api = std::make_unique<KrakenAPI>(config.paper_trading);
+        if (!config.replay_file.empty()) {
+            api->replay_session(config.replay_file, config.replay_speed);
+        } else if (!config.capture_file.empty()) {
+            api->capture_session(config.capture_file);
+        }
+        if (config.worker >= 0) {
+            shard = std::make_unique<ShardLink>(config.shard_segment, static_cast<uint32_t>(config.worker));
+            // Every worker uses the same key: a share of its rate budget,
+            // and private calls in nonce order across processes
+            api->share_rate_limits(shard->shards());
+            api->wrap_transport([&](RequestScheduler::Transport inner) {
+                return shard->serialize_private(std::move(inner));
+            });
+        }
+        if (config.async_feed) {
+            if (!config.replay_file.empty() || !config.capture_file.empty()) {
+                std::cerr << "⚠️  --async-feed ignored: capture/replay only covers the blocking client" << std::endl;
+            } else {
+                // Same scheduler, so the feed stays inside this process's rate budget
+                feed_loop = std::make_unique<EventLoop>();
+                async_api = std::make_unique<AsyncKrakenAPI>(*feed_loop, api->request_scheduler(), config.paper_trading);
+            }
+        }
         learning_engine = std::make_unique<LearningEngine>();
+        if (config.record_ticks) {
+            tick_recorder = std::make_unique<TickRecorder>(config.tick_history_dir);
+        }
+        if (config.publish_stats) {
+            try {
+                stats = std::make_unique<StatsPublisher>(config.stats_segment);
+                learning_engine->set_stats_publisher(stats.get());
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️  Live stats disabled: " << e.what() << std::endl;
+            }
+        }
         
         std::cout << "\n🤖 KRAKEN TRADING BOT v1.0 (C++)" << std::endl;
         std::cout << "Mode: " << (config.paper_trading ? "PAPER TRADING" : "LIVE TRADING") << std::endl;
         std::cout << "Learning enabled: " << (config.enable_learning ? "YES" : "NO") << std::endl;
+        std::cout << "Tick history: " << (config.record_ticks ? config.tick_history_dir : "OFF") << std::endl;
+        if (!config.replay_file.empty()) {
+            std::cout << "Replaying: " << config.replay_file << " @ "
+                      << (config.replay_speed > 0 ? std::to_string(config.replay_speed) + "x" : "max speed") << std::endl;
+        } else if (!config.capture_file.empty()) {
+            std::cout << "Capturing session: " << config.capture_file << std::endl;
+        }
+        std::cout << "Live stats: " << (stats ? "/dev/shm" + config.stats_segment : "OFF") << std::endl;
+        std::cout << "Ticker feed: " << (async_api ? "async, batches in parallel" : "blocking") << std::endl;
+        std::cout << "Risk: daily loss $" << config.max_daily_loss_usd << ", cooldown "
+                  << config.loss_cooldown_seconds << "s after " << config.max_consecutive_losses << " losses" << std::endl;
+        if (shard) {
+            std::cout << "Shard: " << shard->shard() << " of " << shard->shards() << " (account risk via /dev/shm"
+                      << config.shard_segment << ")" << std::endl;
+        }
+        if (config.threaded) {
+            std::cout << "Threads: feed/strategy/execution/analytics on CPUs " << config.feed_cpu << "/"
+                      << config.strategy_cpu << "/" << config.execution_cpu << "/" << config.analytics_cpu
+                      << (config.busy_poll ? " (busy-poll)" : "") << std::endl;
+        }
         std::cout << "=================================\n" << std::endl;
     }
     
@@ -41,153 +159,67 @@ public:
     
     // Main trading loop
     void run() {
-        std::cout << "📊 Authenticating with Kraken..." << std::endl;
-        if (!api->authenticate()) {
-            std::cerr << "❌ Authentication failed. Check KRAKEN_API_KEY and KRAKEN_API_SECRET." << std::endl;
+        if (!start_session()) return;
+        
+        std::cout << "\n▶️  Starting trading loop..." << std::endl;
+        std::cout << "Press Ctrl+C to stop\n" << std::endl;
+        
+        if (config.threaded) {
+            run_threaded();
+            flatten_stranded();
             return;
         }
-        std::cout << "✅ Authenticated successfully" << std::endl;
-        
-        // Get available pairs
-        auto pairs = api->get_trading_pairs();
-        std::cout << "\n📈 Available trading pairs: " << pairs.size() << std::endl;
         
         int trade_count = 0;
         bool running = true;
         
-        std::cout << "\n▶️  Starting trading loop..." << std::endl;
-        std::cout << "Press Ctrl+C to stop\n" << std::endl;
-        
-        while (running) {
+        while (running && !stop_requested) {
             try {
-                // 1. SCAN PAIRS FOR OPPORTUNITIES
-                std::cout << "\n[" << trade_count + 1 << "] 🔍 Scanning " << pairs.size() << " pairs..." << std::endl;
-                
-                std::string best_pair = "";
-                double best_volatility = 0;
-                StrategyConfig best_strategy;
-                
-                for (const auto& pair : pairs) {
-                    try {
-                        auto ticker = api->get_ticker(pair);
-                        double volatility = ticker.value("vola_24h", 0.0);
-                        double spread = api->get_bid_ask_spread(pair);
-                        
-                        // Filter by spread
-                        if (spread > 0.1) continue;  // Skip illiquid
-                        
-                        // Get strategy for this pair
-                        auto strategy = learning_engine->get_optimal_strategy(pair, volatility);
-                        
-                        if (volatility > best_volatility && strategy.has_edge) {
-                            best_volatility = volatility;
-                            best_pair = pair;
-                            best_strategy = strategy;
-                        }
-                    } catch (...) {
-                        // Skip on error
-                    }
+                // Positions whose exit did not fill are closed first
+                for (auto& trade : retry_stranded_exits()) {
+                    std::lock_guard<std::mutex> lock(learning_mutex);
+                    learning_engine->record_trade(trade);
+                    trade_count++;
                 }
                 
-                if (best_pair.empty()) {
-                    std::cout << "  ⏳ No good opportunities found, waiting..." << std::endl;
-                    std::this_thread::sleep_for(5s);
+                // Daily loss breaker / losing-streak cooldown
+                if (RiskVerdict gate = entry_gate(); gate != RiskVerdict::Allowed) {
+                    std::cout << "  🛑 Trading paused (" << to_string(gate) << ")" << std::endl;
+                    pause(30s);
                     continue;
                 }
                 
-                std::cout << "  ✅ Found opportunity: " << best_pair 
-                          << " (volatility: " << best_volatility << "%, strategy: " 
-                          << best_strategy.name << ")" << std::endl;
-                
-                // 2. EXECUTE TRADE
-                std::cout << "  📍 Entering position..." << std::endl;
+                // 1. SCAN PAIRS FOR OPPORTUNITIES
+                std::cout << "\n[" << trade_count + 1 << "] 🔍 Scanning " << pairs.size() << " pairs..." << std::endl;
                 
-                Order order = api->place_market_order(
-                    best_pair,
-                    "buy",
-                    config.position_size_usd / api->get_current_price(best_pair),
-                    best_strategy.leverage
-                );
+                auto tickers = fetch_tickers();
+                auto opportunity = find_opportunity(tickers);
+                if (!opportunity) {
+                    std::cout << "  ⏳ No good opportunities found, waiting..." << std::endl;
+                    pause(5s);
+                    continue;
+                }
                 
-                if (order.status == "filled") {
-                    std::cout << "  ✅ Order filled: " << order.volume << " " << best_pair 
-                              << " @ $" << order.price << " (" << best_strategy.leverage << "x)" << std::endl;
-                    
-                    // 3. HOLD AND MONITOR
-                    double entry_price = order.price;
-                    double current_price = entry_price;
-                    auto entry_time = std::chrono::system_clock::now();
-                    
-                    std::cout << "  ⏱️  Holding for " << best_strategy.timeframe_seconds << "s..." << std::endl;
-                    
-                    for (int i = 0; i < best_strategy.timeframe_seconds; i++) {
-                        current_price = api->get_current_price(best_pair);
-                        double unrealized_pnl = (current_price - entry_price) * order.volume;
-                        double unrealized_pct = ((current_price - entry_price) / entry_price) * 100;
-                        
-                        // Check for early exit
-                        if (unrealized_pnl > (config.position_size_usd * best_strategy.take_profit_pct)) {
-                            std::cout << "  🎯 Take profit hit (" << unrealized_pct << "%)!" << std::endl;
-                            break;
-                        }
-                        if (unrealized_pnl < -(config.position_size_usd * best_strategy.stop_loss_pct)) {
-                            std::cout << "  ⛔ Stop loss triggered (" << unrealized_pct << "%)!" << std::endl;
-                            break;
-                        }
-                        
-                        std::cout << "    " << i << "s: " << best_pair << " @ $" << current_price 
-                                  << " (" << std::fixed << std::setprecision(2) << unrealized_pnl 
-                                  << " / " << unrealized_pct << "%)" << std::endl;
-                        
-                        std::this_thread::sleep_for(1s);
-                    }
-                    
-                    // 4. EXIT TRADE
-                    std::cout << "  📊 Closing position..." << std::endl;
-                    Order exit_order = api->place_market_order(best_pair, "sell", order.volume, 1.0);
-                    
-                    if (exit_order.status == "filled") {
-                        double exit_price = exit_order.price;
-                        double gross_pnl = (exit_price - entry_price) * order.volume;
-                        double fees = config.position_size_usd * 0.004;  // 0.4% fee
-                        double net_pnl = gross_pnl - fees;
-                        double roi = (net_pnl / config.position_size_usd) * 100;
-                        
-                        std::cout << "  ✅ Exit @ $" << exit_price << "\n" << std::endl;
-                        std::cout << "  💰 RESULT: " << (net_pnl > 0 ? "+" : "") << net_pnl 
-                                  << " (" << roi << "%)" << std::endl;
-                        std::cout << "  =========================\n" << std::endl;
-                        
-                        // 5. RECORD TRADE
-                        TradeRecord trade;
-                        trade.pair = best_pair;
-                        trade.entry_price = entry_price;
-                        trade.exit_price = exit_price;
-                        trade.leverage = best_strategy.leverage;
-                        trade.position_size = config.position_size_usd;
-                        trade.pnl = net_pnl;
-                        trade.gross_pnl = gross_pnl;
-                        trade.fees_paid = fees;
-                        trade.timestamp = entry_time;
-                        trade.exit_reason = net_pnl > 0 ? "take_profit" : "timeout";
-                        trade.timeframe_seconds = best_strategy.timeframe_seconds;
-                        trade.volatility_at_entry = best_volatility;
-                        
-                        learning_engine->record_trade(trade);
-                        trade_count++;
-                    }
-                } else {
-                    std::cout << "  ❌ Order failed to fill" << std::endl;
+                // 2-4. ENTER, HOLD, EXIT
+                if (auto trade = execute_trade(*opportunity)) {
+                    // 5. RECORD TRADE
+                    std::lock_guard<std::mutex> lock(learning_mutex);
+                    learning_engine->record_trade(*trade);
+                    trade_count++;
                 }
                 
                 // Brief cooldown
-                std::this_thread::sleep_for(2s);
+                pause(2s);
                 
+            } catch (const ReplayExhausted& e) {
+                std::cout << "\n🏁 Replay finished (" << e.what() << ")" << std::endl;
+                running = false;
             } catch (const std::exception& e) {
                 std::cerr << "  ❌ Error: " << e.what() << std::endl;
-                std::this_thread::sleep_for(5s);
+                pause(5s);
             }
         }
+        flatten_stranded();
     }
     
     // One-click live deployment
@@ -217,11 +249,779 @@ public:
     }
     
 private:
+    struct Opportunity {
+        Symbol pair;
+        double volatility = 0;
+        double spread = 0;
+        StrategyConfig strategy;
+    };
+    
+    bool start_session() {
+        std::cout << "📊 Authenticating with Kraken..." << std::endl;
+        if (!api->authenticate()) {
+            std::cerr << "❌ Authentication failed. Check KRAKEN_API_KEY and KRAKEN_API_SECRET." << std::endl;
+            return false;
+        }
+        std::cout << "✅ Authenticated successfully" << std::endl;
+        if (async_api) feed_loop->run_until_complete(async_api->load_instruments());
+        
+        // Get available pairs
+        pairs = api->get_trading_pairs();
+        std::cout << "\n📈 Available trading pairs: " << pairs.size() << std::endl;
+        if (shard) {
+            size_t available = pairs.size();
+            std::erase_if(pairs, [&](const std::string& pair) { return !shard->owns(pair); });
+            std::cout << "🧩 Shard " << shard->shard() << " trades " << pairs.size() << " of " << available << std::endl;
+        }
+        
+        // Learning-engine slots are stable, so resolve them once
+        pair_slots.clear();
+        pair_slots.reserve(pairs.size());
+        for (const auto& pair : pairs) pair_slots.push_back(learning_engine->pair_slot(pair));
+        
+        portfolio = std::make_unique<PortfolioEngine>(api->get_equity(), risk_limits(config));
+        books = std::make_unique<OrderBookSet>(pairs.size(), config.book_depth);
+        std::cout << "💼 Starting equity: " << portfolio->equity() << std::endl;
+        return true;
+    }
+    
+    // Only ever called from one thread (the feed thread when threaded),
+    // which is the thread feed_loop runs on
+    std::map<std::string, json> fetch_tickers() {
+        // Batched, rate-limited Ticker calls instead of one per pair; with
+        // --async-feed the batches are in flight together
+        auto fetch_start = std::chrono::steady_clock::now();
+        auto tickers = async_api ? feed_loop->run_until_complete(async_api->get_tickers(pairs))
+                                 : shared_api()->get_tickers(pairs);
+        record_latency(LatencyKind::MarketData, fetch_start);
+        if (tick_recorder) record_tickers(tickers);
+        return tickers;
+    }
+    
+    // Spread in % of mid from the snapshot's best bid / ask; the API's
+    // estimate only when the ticker carries no book top
+    double spread_pct(const std::string& pair, const json& ticker) {
+        if (ticker.contains("a") && ticker.contains("b")) {
+            double ask = std::stod(ticker["a"][0].get<std::string>());
+            double bid = std::stod(ticker["b"][0].get<std::string>());
+            if (ask > 0 && bid > 0) return (ask - bid) / ((ask + bid) / 2) * 100;
+        }
+        return shared_api()->get_bid_ask_spread(pair);
+    }
+    
+    std::optional<Opportunity> find_opportunity(const std::map<std::string, json>& tickers) {
+        auto decision_start = std::chrono::steady_clock::now();
+        
+        scan_pairs.clear();
+        scan_slots.clear();
+        scan_volatility.clear();
+        scan_spread.clear();
+        for (size_t i = 0; i < pairs.size(); i++) {
+            try {
+                auto ticker_it = tickers.find(pairs[i]);
+                if (ticker_it == tickers.end()) continue;
+                const auto& ticker = ticker_it->second;
+                double volatility = ticker.value("vola_24h", 0.0);
+                double spread = spread_pct(pairs[i], ticker);
+                
+                // Filter by spread - skip illiquid
+                if (!entry_filter.allows({volatility, spread})) continue;
+                
+                scan_pairs.push_back(i);
+                scan_slots.push_back(pair_slots[i]);
+                scan_volatility.push_back(volatility);
+                scan_spread.push_back(spread);
+            } catch (...) {
+                // Skip on error
+            }
+        }
+        
+        // Strategies for every candidate in one pass over the index
+        std::optional<Opportunity> best;
+        {
+            std::lock_guard<std::mutex> lock(learning_mutex);
+            learning_engine->get_optimal_strategies(scan_slots, scan_volatility, scan_strategy);
+            size_t best_j = scan_pairs.size();
+            for (size_t j = 0; j < scan_pairs.size(); j++) {
+                if (best_j == scan_pairs.size() || scan_volatility[j] > scan_volatility[best_j]) {
+                    best_j = j;
+                }
+            }
+            if (best_j < scan_pairs.size() && scan_volatility[best_j] > 0) {
+                best = Opportunity{pairs[scan_pairs[best_j]], scan_volatility[best_j], scan_spread[best_j],
+                                   *scan_strategy[best_j]};
+            }
+        }
+        
+        record_latency(LatencyKind::Decision, decision_start);
+        return best;
+    }
+    
+    // Enter, hold and exit one position; the trade if it completed
+    std::optional<TradeRecord> execute_trade(const Opportunity& opportunity) {
+        const Symbol& best_pair = opportunity.pair;
+        const StrategyConfig& best_strategy = opportunity.strategy;
+        
+        std::cout << "  ✅ Found opportunity: " << best_pair 
+                  << " (volatility: " << opportunity.volatility << "%, strategy: " 
+                  << best_strategy.name << ")" << std::endl;
+        if (closing(best_pair)) {
+            std::cout << "  ⏳ " << best_pair << " still has an exit to retry, skipping" << std::endl;
+            return std::nullopt;
+        }
+        
+        // 2. EXECUTE TRADE
+        std::cout << "  📍 Entering position..." << std::endl;
+        
+        // Size in exact lots of the pair (rounded down, never over budget)
+        const InstrumentSpec& spec = api->get_instrument(best_pair);
+        Notional position_size = sizing.size_for({opportunity.volatility, opportunity.spread});
+        
+        // Walk the L2 book for what this size really costs
+        OrderBookSet::BookSlot book_slot = books->slot_for(spec);
+        json depth = shared_api()->get_depth(best_pair.str(), config.book_depth);
+        books->apply_snapshot(book_slot, depth);
+        if (tick_recorder) record_depth(spec, depth);
+        FillEstimate fill = books->estimate_fill(book_slot, Side::Buy, position_size);
+        if (!fill.complete || fill.slippage_bps > config.max_slippage_bps) {
+            std::cout << "  📚 Book too thin for $" << position_size << " (slippage " << fill.slippage_bps
+                      << " bps" << (fill.complete ? "" : ", not enough depth") << "), skipping" << std::endl;
+            return std::nullopt;
+        }
+        std::cout << "  📚 Est. slippage " << fill.slippage_bps << " bps, depth imbalance "
+                  << books->imbalance(book_slot) << std::endl;
+        
+        Price quote = shared_api()->get_current_price(best_pair);
+        PortfolioEngine::PairSlot holding = portfolio->slot_for(spec);
+        
+        // Sizing and the local pre-trade risk check run on preallocated
+        // state only; a counting build aborts if that ever changes
+        AllocationScope decision_allocations;
+        Qty entry_volume = spec.qty_for_notional(position_size, quote);
+        bool sized = spec.meets_minimum(entry_volume);
+        RiskVerdict verdict = sized && !shard
+            ? portfolio->check(holding, Side::Buy, quote, entry_volume, best_strategy.leverage)
+            : RiskVerdict::Allowed;
+        decision_allocations.expect_none("sizing + risk check");
+        if (!sized) {
+            std::cout << "  ⚠️  $" << position_size << " is below the minimum order for "
+                      << best_pair << ", skipping" << std::endl;
+            return std::nullopt;
+        }
+        
+        // When sharded the account's totals live in the coordinator
+        if (shard) verdict = shard->check(spec, Side::Buy, quote, entry_volume, best_strategy.leverage);
+        if (verdict != RiskVerdict::Allowed) {
+            std::cout << "  🛑 Risk check blocked entry: " << to_string(verdict) << std::endl;
+            return std::nullopt;
+        }
+        auto order_start = std::chrono::steady_clock::now();
+        Order order;
+        try {
+            order = shared_api()->place_market_order(
+                best_pair,
+                Side::Buy,
+                entry_volume,
+                best_strategy.leverage
+            );
+        } catch (...) {
+            if (shard) shard->release(spec);  // Free the coordinator's reservation
+            throw;
+        }
+        record_latency(LatencyKind::Order, order_start);
+        
+        if (order.status != OrderStatus::Filled) {
+            std::cout << "  ❌ Order failed to fill" << std::endl;
+            if (shard) shard->release(spec);
+            return std::nullopt;
+        }
+        
+        std::cout << "  ✅ Order filled: " << spec.format(order.filled) << " " << best_pair 
+                  << " @ $" << spec.format(order.price) << " (" << best_strategy.leverage << "x)" << std::endl;
+        
+        // 3. HOLD AND MONITOR
+        Price entry_price = order.price;
+        portfolio->on_fill(holding, Side::Buy, entry_price, order.filled, best_strategy.leverage);
+        if (shard) shard->on_fill(spec, Side::Buy, entry_price, order.filled, best_strategy.leverage, true);
+        if (stats) stats->on_position_open(spec, entry_price, order.filled, best_strategy.leverage);
+        auto entry_time = std::chrono::system_clock::now();
+        
+        std::cout << "  ⏱️  Holding for " << best_strategy.timeframe_seconds << "s..." << std::endl;
+        
+        // Exit rules specialised for this strategy's shape
+        HoldResult hold = with_exit_policy(best_strategy, config.position_size_usd,
+            [&](const auto& exit_rule) {
+                return hold_position(best_pair, spec, holding, order, best_strategy.timeframe_seconds, exit_rule);
+            });
+        
+        // 4. EXIT TRADE
+        std::cout << "  📊 Closing position..." << std::endl;
+        return close_trade({opportunity, &spec, holding, entry_price, entry_time, hold});
+    }
+    
+    // Feed -> strategy -> execution -> analytics, one thread each, joined by
+    // SPSC queues. Only the freshest ticker snapshot is scanned, and a new
+    // opportunity is only taken while no position is open. The strategy
+    // thread works from the snapshot alone; feed and execution share the
+    // API through shared_api().
+    void run_threaded() {
+        using TickerSnapshot = std::shared_ptr<const std::map<std::string, json>>;
+        
+        if (config.lock_memory && realtime::lock_process_memory()) {
+            std::cout << "🔒 Process memory locked" << std::endl;
+        }
+        
+        SpscQueue<TickerSnapshot> feed_queue(64, config.huge_pages);
+        SpscQueue<Opportunity> order_queue(16, config.huge_pages);
+        SpscQueue<TradeRecord> trade_queue(1024, config.huge_pages);
+        std::atomic<bool> stop{false};
+        std::atomic<bool> in_position{false};
+        
+        JitterStats feed_wakeup, strategy_handoff, execution_handoff, execution_wakeup, analytics_handoff;
+        auto feed_interval = std::chrono::milliseconds(config.feed_interval_ms);
+        
+        auto on_error = [&](const char* role, const std::exception& e) {
+            if (dynamic_cast<const ReplayExhausted*>(&e)) {
+                std::cout << "\n🏁 Replay finished (" << e.what() << ")" << std::endl;
+                stop = true;
+            } else {
+                std::cerr << "  ❌ " << role << " error: " << e.what() << std::endl;
+            }
+        };
+        
+        std::thread feed([&] {
+            realtime::pin_current_thread(config.feed_cpu, "kb-feed");
+            auto next = realtime::clock::now();
+            while (!stop && !stop_requested) {
+                try {
+                    auto snapshot = std::make_shared<const std::map<std::string, json>>(fetch_tickers());
+                    feed_queue.try_push(std::move(snapshot));  // Full = strategy is behind; it skips to the newest anyway
+                } catch (const std::exception& e) {
+                    on_error("Feed", e);
+                }
+                // Fixed cadence; after an overrun start again from now instead of bursting
+                next = std::max(next + scaled(feed_interval), realtime::clock::now());
+                feed_wakeup.record(realtime::wait_until(next, config.busy_poll));
+            }
+        });
+        
+        std::thread strategy([&] {
+            realtime::pin_current_thread(config.strategy_cpu, "kb-strategy");
+            TickerSnapshot snapshot, newer;
+            while (feed_queue.pop_wait(snapshot, stop, false, &strategy_handoff)) {
+                while (feed_queue.try_pop(newer)) snapshot = std::move(newer);
+                if (in_position.load(std::memory_order_acquire)) continue;
+                try {
+                    if (auto opportunity = find_opportunity(*snapshot)) {
+                        in_position.store(true, std::memory_order_release);
+                        order_queue.try_push(std::move(*opportunity));
+                    }
+                } catch (const std::exception& e) {
+                    on_error("Strategy", e);
+                }
+            }
+        });
+        
+        std::thread execution([&] {
+            realtime::pin_current_thread(config.execution_cpu, "kb-execution");
+            busy_poll_thread = config.busy_poll;
+            wakeup_jitter = &execution_wakeup;
+            Opportunity opportunity;
+            while (order_queue.pop_wait(opportunity, stop, config.busy_poll, &execution_handoff)) {
+                try {
+                    for (auto& trade : retry_stranded_exits()) trade_queue.try_push(std::move(trade));
+                    if (auto trade = execute_trade(opportunity)) trade_queue.try_push(std::move(*trade));
+                } catch (const std::exception& e) {
+                    on_error("Execution", e);
+                }
+                in_position.store(false, std::memory_order_release);
+            }
+        });
+        
+        std::thread analytics([&] {
+            realtime::pin_current_thread(config.analytics_cpu, "kb-analytics");
+            TradeRecord trade;
+            while (trade_queue.pop_wait(trade, stop, false, &analytics_handoff)) {
+                std::lock_guard<std::mutex> lock(learning_mutex);
+                learning_engine->record_trade(trade);
+            }
+        });
+        
+        // Runs until a thread stops the session (e.g. end of a replay) or a
+        // stop is requested
+        feed.join();
+        stop = true;
+        feed_queue.wake();
+        order_queue.wake();
+        trade_queue.wake();
+        strategy.join();
+        execution.join();
+        analytics.join();
+        
+        std::cout << "\n⏱️  THREAD JITTER (" << (config.busy_poll ? "busy-poll" : "blocking") << ")" << std::endl;
+        std::cout << "  feed wake-up:        " << feed_wakeup.summary() << std::endl;
+        std::cout << "  feed -> strategy:    " << strategy_handoff.summary() << std::endl;
+        std::cout << "  strategy -> exec:    " << execution_handoff.summary() << std::endl;
+        std::cout << "  exec wake-up:        " << execution_wakeup.summary() << std::endl;
+        std::cout << "  exec -> analytics:   " << analytics_handoff.summary() << std::endl;
+    }
+    
+    struct HoldResult {
+        Qty remaining;           // Still to sell at exit
+        Notional realized_pnl;   // Banked by partial exits
+        ExitReason reason = ExitReason::Timeout;
+    };
+    
+    // Per-tick monitoring, instantiated once per exit policy shape
+    template <ExitRule Rule>
+    HoldResult hold_position(const Symbol& pair, const InstrumentSpec& spec, PortfolioEngine::PairSlot holding,
+                             const Order& order, int timeframe_seconds, const Rule& exit_rule) {
+        HoldResult result{order.filled, Notional{}, ExitReason::Timeout};
+        Price entry_price = order.price;
+        Notional open_cost = spec.notional(entry_price, result.remaining);
+        TickState state;
+        
+        for (int i = 0; i < timeframe_seconds; i++) {
+            Price current_price = shared_api()->get_current_price(pair);
+            state.pnl = result.realized_pnl + spec.notional(current_price, result.remaining) - open_cost;
+            state.peak = std::max(state.peak, state.pnl);
+            if (stats) stats->on_mark(pair, current_price, result.remaining, state.pnl);
+            portfolio->on_mark(holding, current_price);
+            if (shard) shard->on_mark(pair, current_price, result.remaining, state.pnl);
+            double move_pct = (double)(current_price - entry_price).ticks / entry_price.ticks * 100;
+            
+            if (stop_requested) {
+                result.reason = ExitReason::Manual;
+                std::cout << "  🛑 Stopping - closing position" << std::endl;
+                break;
+            }
+            
+            // Daily loss breaker tripped (this mark or elsewhere) - get flat now
+            if (shard ? shard->halted() : portfolio->halted()) {
+                result.reason = ExitReason::Manual;
+                std::cout << "  🛑 Daily loss limit hit - closing position" << std::endl;
+                break;
+            }
+            
+            ExitSignal signal = exit_rule.check(state);
+            if (signal.action == ExitAction::Exit) {
+                result.reason = signal.reason;
+                if (signal.reason == ExitReason::TakeProfit) {
+                    std::cout << "  🎯 Take profit hit (" << move_pct << "%)!" << std::endl;
+                } else if (signal.reason == ExitReason::TrailingStop) {
+                    std::cout << "  📉 Trailing stop hit (" << move_pct << "%)!" << std::endl;
+                } else {
+                    std::cout << "  ⛔ Stop loss triggered (" << move_pct << "%)!" << std::endl;
+                }
+                break;
+            }
+            if (signal.action == ExitAction::PartialExit) {
+                state.partial_taken = true;
+                Qty half{result.remaining.lots / 2};
+                if (spec.meets_minimum(half) && spec.meets_minimum(result.remaining - half)) {
+                    auto partial_start = std::chrono::steady_clock::now();
+                    Order partial = shared_api()->place_market_order(pair, Side::Sell, half, 1.0);
+                    record_latency(LatencyKind::Order, partial_start);
+                    if (partial.status == OrderStatus::Filled) {
+                        portfolio->on_fill(holding, Side::Sell, partial.price, partial.filled, 1.0);
+                        if (shard) shard->on_fill(spec, Side::Sell, partial.price, partial.filled, 1.0);
+                        result.realized_pnl += spec.notional(partial.price, partial.filled)
+                                             - spec.notional(entry_price, partial.filled);
+                        result.remaining = result.remaining - partial.filled;
+                        open_cost = spec.notional(entry_price, result.remaining);
+                        std::cout << "  💵 Partial exit: " << spec.format(partial.filled) << " @ $"
+                                  << spec.format(partial.price) << std::endl;
+                    }
+                }
+            }
+            
+            std::cout << "    " << i << "s: " << pair << " @ $" << spec.format(current_price) 
+                      << " (" << state.pnl << " / " << std::fixed << std::setprecision(2)
+                      << move_pct << "%)" << std::endl;
+            
+            pause(1s);
+        }
+        
+        return result;
+    }
+    
+    // An entered position from its exit order on. If the exit does not
+    // fill, the portfolio, shard and live stats keep the position open and
+    // it is retried before the next entry.
+    struct OpenTrade {
+        Opportunity opportunity;
+        const InstrumentSpec* spec = nullptr;
+        PortfolioEngine::PairSlot holding{};
+        Price entry_price;
+        std::chrono::system_clock::time_point entry_time;
+        HoldResult hold;
+    };
+    static constexpr int EXIT_ATTEMPTS = 3;
+    
+    // Sell what is left (a few attempts, backing off); the trade if it closed
+    std::optional<TradeRecord> close_trade(OpenTrade open) {
+        const Symbol& pair = open.opportunity.pair;
+        Order exit_order;
+        for (int attempt = 0; attempt < EXIT_ATTEMPTS && exit_order.status != OrderStatus::Filled; attempt++) {
+            if (attempt > 0) pause(std::chrono::seconds(1 << attempt));
+            auto exit_start = std::chrono::steady_clock::now();
+            try {
+                exit_order = shared_api()->place_market_order(pair, Side::Sell, open.hold.remaining, 1.0);
+            } catch (const ReplayExhausted&) {
+                stranded.push_back(std::move(open));
+                throw;
+            } catch (const std::exception& e) {
+                std::cerr << "  ⚠️  Exit order for " << pair << " failed: " << e.what() << std::endl;
+            }
+            record_latency(LatencyKind::Order, exit_start);
+        }
+        
+        if (exit_order.status != OrderStatus::Filled) {
+            std::cout << "  ⚠️  Exit did not fill after " << EXIT_ATTEMPTS << " attempts - "
+                      << open.spec->format(open.hold.remaining) << " " << pair
+                      << " stays open and is retried before the next entry" << std::endl;
+            stranded.push_back(std::move(open));
+            return std::nullopt;
+        }
+        if (stats) stats->on_position_closed(pair);
+        return finish_trade(open, exit_order);
+    }
+    
+    // Exits that did not fill earlier; the trades that closed now
+    std::vector<TradeRecord> retry_stranded_exits() {
+        std::vector<TradeRecord> closed;
+        std::vector<OpenTrade> pending;
+        pending.swap(stranded);
+        for (auto& open : pending) {
+            std::cout << "  🔁 Retrying exit for " << open.opportunity.pair << std::endl;
+            if (auto trade = close_trade(std::move(open))) closed.push_back(std::move(*trade));
+        }
+        return closed;
+    }
+    
+    // Session end: one last try at exits that never filled
+    void flatten_stranded() {
+        try {
+            for (auto& trade : retry_stranded_exits()) {
+                std::lock_guard<std::mutex> lock(learning_mutex);
+                learning_engine->record_trade(trade);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "  ❌ Error closing positions: " << e.what() << std::endl;
+        }
+        for (const auto& open : stranded) {
+            std::cerr << "  ⚠️  Still open: " << open.spec->format(open.hold.remaining) << " "
+                      << open.opportunity.pair << std::endl;
+        }
+    }
+    
+    bool closing(const Symbol& pair) const {
+        return std::any_of(stranded.begin(), stranded.end(),
+                           [&](const OpenTrade& open) { return open.opportunity.pair == pair; });
+    }
+    
+    // Books the filled exit everywhere and builds the trade record
+    TradeRecord finish_trade(const OpenTrade& open, const Order& exit_order) {
+        // Exact integer P&L; doubles only for the learning statistics
+        Price exit_price = exit_order.price;
+        Notional gross_pnl = open.hold.realized_pnl + open.spec->notional(exit_price, exit_order.filled)
+                           - open.spec->notional(open.entry_price, open.hold.remaining);
+        Notional fees = Notional::from_double(config.position_size_usd * 0.004);  // 0.4% fee
+        Notional net_pnl = gross_pnl - fees;
+        double roi = (net_pnl.to_double() / config.position_size_usd) * 100;
+        session_pnl += net_pnl;
+        
+        portfolio->on_fill(open.holding, Side::Sell, exit_price, exit_order.filled, 1.0);
+        portfolio->charge_fee(fees);
+        portfolio->on_trade_closed(net_pnl);
+        if (shard) {
+            shard->on_fill(*open.spec, Side::Sell, exit_price, exit_order.filled, 1.0);
+            shard->charge_fee(fees);
+            shard->on_trade_closed(open.opportunity.pair, net_pnl);
+        }
+        
+        std::cout << "  ✅ Exit @ $" << open.spec->format(exit_price) << "\n" << std::endl;
+        std::cout << "  💰 RESULT: " << (net_pnl.raw > 0 ? "+" : "") << net_pnl 
+                  << " (" << roi << "%) | Session: " << session_pnl << std::endl;
+        if (shard) {
+            std::cout << "  💼 Account equity: " << shard->account_equity() << " | Day: " << shard->account_daily_pnl()
+                      << " | Drawdown: " << shard->account_drawdown() << std::endl;
+        } else {
+            std::cout << "  💼 Equity: " << portfolio->equity() << " | Day: " << portfolio->daily_pnl()
+                      << " | Drawdown: " << portfolio->intraday_drawdown() << std::endl;
+        }
+        if (!shard && portfolio->cooldown_until() > std::chrono::system_clock::now()) {
+            std::cout << "  🧊 " << config.max_consecutive_losses << " losses in a row - cooling down for "
+                      << config.loss_cooldown_seconds << "s" << std::endl;
+        }
+        std::cout << "  =========================\n" << std::endl;
+        
+        TradeRecord trade;
+        trade.pair = open.opportunity.pair;
+        trade.entry_price = open.spec->to_double(open.entry_price);
+        trade.exit_price = open.spec->to_double(exit_price);
+        trade.leverage = open.opportunity.strategy.leverage;
+        trade.position_size = config.position_size_usd;
+        trade.pnl = net_pnl.to_double();
+        trade.gross_pnl = gross_pnl.to_double();
+        trade.fees_paid = fees.to_double();
+        trade.timestamp = open.entry_time;
+        trade.exit_reason = open.hold.reason;
+        trade.timeframe_seconds = open.opportunity.strategy.timeframe_seconds;
+        trade.volatility_at_entry = open.opportunity.volatility;
+        trade.bid_ask_spread = open.opportunity.spread;
+        if (shard) shard->record_trade(trade);  // Into the coordinator's merged learning engine
+        return trade;
+    }
+    
+    // KrakenAPI's paper state (positions, orders, mock prices) is not
+    // synchronised. The trading loop reaches the API through shared_api(),
+    // which holds api_mutex for that one call when threaded paper trading:
+    // `shared_api()->get_current_price(pair)`. Live calls only go through
+    // the thread-safe RequestScheduler and never wait on each other here.
+    struct LockedApi {
+        std::unique_lock<std::mutex> lock;
+        KrakenAPI* api;
+        KrakenAPI* operator->() const { return api; }
+    };
+    LockedApi shared_api() {
+        std::unique_lock<std::mutex> lock(api_mutex, std::defer_lock);
+        if (config.threaded && api->is_paper_mode()) lock.lock();
+        return {std::move(lock), api.get()};
+    }
+    
+    // Daily loss breaker / cooldown - account-wide in the coordinator when sharded
+    RiskVerdict entry_gate() {
+        return shard ? shard->entry_gate() : portfolio->entry_gate();
+    }
+    
+    // Wall-clock waits, shortened by the speed-up when replaying a session
+    std::chrono::steady_clock::duration scaled(std::chrono::steady_clock::duration d) const {
+        if (config.replay_file.empty()) return d;
+        if (config.replay_speed <= 0) return {};
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(d / config.replay_speed);
+    }
+    
+    // Spins instead of sleeping on busy-poll threads; wake-up lateness goes
+    // to the thread's jitter stats. Returns early once a stop is requested.
+    void pause(std::chrono::steady_clock::duration d) {
+        auto deadline = realtime::clock::now() + scaled(d);
+        while (!stop_requested) {
+            auto until = std::min(deadline, realtime::clock::now() + 100ms);
+            auto late = realtime::wait_until(until, busy_poll_thread);
+            if (until != deadline) continue;
+            if (wakeup_jitter) wakeup_jitter->record(late);
+            break;
+        }
+    }
+    
+    void record_latency(LatencyKind kind, std::chrono::steady_clock::time_point start) {
+        if (stats) stats->record_latency(kind, std::chrono::steady_clock::now() - start);
+    }
+    
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    
+    // The recorder reports its own write failures (tick_store.hpp)
+    void record_tickers(const std::map<std::string, json>& tickers) {
+        int64_t now = now_us();
+        std::lock_guard<std::mutex> lock(tick_mutex);
+        for (const auto& [pair, ticker] : tickers) {
+            try {
+                tick_recorder->record_ticker(api->get_instrument(pair), ticker, now);
+            } catch (const std::exception&) {
+                // Unknown precision or malformed ticker - history is best effort
+            }
+        }
+        tick_recorder->flush_due(now);
+    }
+    
+    void record_depth(const InstrumentSpec& spec, const json& depth) {
+        std::lock_guard<std::mutex> lock(tick_mutex);
+        try {
+            tick_recorder->record_depth(spec, depth, now_us());
+        } catch (const std::exception&) {
+            // Malformed level - history is best effort
+        }
+    }
+    
     BotConfig config;
+    // Sharded worker's line to the coordinator. Declared before api: the
+    // scheduler's transport (serialize_private) points into it, and its
+    // threads run until api is destroyed
+    std::unique_ptr<ShardLink> shard;
     std::unique_ptr<KrakenAPI> api;
+    std::mutex api_mutex;       // See shared_api()
+    // --async-feed: tickers through the same scheduler; destroyed before api
+    std::unique_ptr<EventLoop> feed_loop;
+    std::unique_ptr<AsyncKrakenAPI> async_api;
+    std::mutex learning_mutex;  // Strategy lookups vs record_trade when threaded
     std::unique_ptr<LearningEngine> learning_engine;
+    std::unique_ptr<TickRecorder> tick_recorder;
+    std::mutex tick_mutex;  // Feed (tickers) vs execution (depth) when threaded
+    std::unique_ptr<StatsPublisher> stats;
+    std::unique_ptr<PortfolioEngine> portfolio;  // Owned by the execution path
+    std::unique_ptr<OrderBookSet> books;         // Likewise
+    Notional session_pnl;  // Exact running P&L across all trades
+    std::vector<OpenTrade> stranded;  // Exits still to retry (execution path only)
+    
+    // Scan state - pairs and their learning-engine slots are resolved once
+    std::vector<std::string> pairs;
+    std::vector<LearningEngine::PairSlot> pair_slots;
+    std::vector<size_t> scan_pairs;
+    std::vector<LearningEngine::PairSlot> scan_slots;
+    std::vector<double> scan_volatility, scan_spread;
+    std::vector<const StrategyConfig*> scan_strategy;
+    const EntryChain<MaxSpread> entry_filter{{MaxSpread{0.1}}};
+    const FixedNotionalSize sizing{Notional::from_double(config.position_size_usd)};
+    
+    static inline thread_local bool busy_poll_thread = false;
+    static inline thread_local JitterStats* wakeup_jitter = nullptr;
 };
 
+namespace {
+    // "trade_log.json" -> "trade_log.shard3.json"
+    std::string shard_file(const std::string& path, int shard) {
+        size_t dot = path.rfind('.');
+        std::string tag = ".shard" + std::to_string(shard);
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos) return path + tag;
+        return path.substr(0, dot) + tag + path.substr(dot);
+    }
+}
+
+// Coordinator: spawns one worker per shard (this binary with the same
+// options plus --worker K, output to shard_K.log) and serves account-level
+// risk and merged learning until they have all exited
+static int run_sharded(const BotConfig& config, int argc, char* argv[]) {
+    KrakenAPI api(config.paper_trading);
+    std::cout << "📊 Authenticating with Kraken..." << std::endl;
+    if (!api.authenticate()) {
+        std::cerr << "❌ Authentication failed. Check KRAKEN_API_KEY and KRAKEN_API_SECRET." << std::endl;
+        return 1;
+    }
+    
+    auto shards = static_cast<uint32_t>(config.shards);
+    ShardCoordinator coordinator(config.shard_segment, shards, api.get_equity(), risk_limits(config));
+    std::unique_ptr<StatsPublisher> stats;
+    if (config.publish_stats) {
+        try {
+            stats = std::make_unique<StatsPublisher>(config.stats_segment);
+            coordinator.set_stats_publisher(stats.get());
+        } catch (const std::exception& e) {
+            std::cerr << "⚠️  Live stats disabled: " << e.what() << std::endl;
+        }
+    }
+    
+    std::cout << "\n🧭 SHARD COORDINATOR (" << shards << " workers)" << std::endl;
+    std::cout << "Mode: " << (config.paper_trading ? "PAPER TRADING" : "LIVE TRADING") << std::endl;
+    std::cout << "Account equity: " << coordinator.portfolio().equity() << std::endl;
+    std::cout << "Risk: daily loss $" << config.max_daily_loss_usd << ", " << config.max_concurrent_trades
+              << " positions max, cooldown " << config.loss_cooldown_seconds << "s after "
+              << config.max_consecutive_losses << " losses" << std::endl;
+    std::cout << "Transport: /dev/shm" << coordinator.segment_name() << std::endl;
+    std::cout << "Live stats (merged): " << (stats ? "/dev/shm" + config.stats_segment : "OFF") << std::endl;
+    std::cout << "=================================\n" << std::endl;
+    
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    
+    std::vector<pid_t> workers(shards, -1);
+    size_t running = 0;
+    for (uint32_t k = 0; k < shards && !stop_requested; k++) {
+        std::vector<std::string> args(argv, argv + argc);
+        args.push_back("--worker");
+        args.push_back(std::to_string(k));
+        std::vector<char*> child_argv;
+        for (auto& arg : args) child_argv.push_back(arg.data());
+        child_argv.push_back(nullptr);
+        
+        std::string log = "shard_" + std::to_string(k) + ".log";
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        int error = posix_spawn(&workers[k], "/proc/self/exe", &actions, nullptr, child_argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (error != 0) {
+            std::cerr << "❌ Could not start shard " << k << ": " << std::strerror(error) << std::endl;
+            workers[k] = -1;
+            stop_requested = 1;
+            break;
+        }
+        running++;
+        std::cout << "🧩 Shard " << k << " started (pid " << workers[k] << ", log " << log << ")" << std::endl;
+    }
+    
+    auto reap = [&](int flags) {
+        int status = 0;
+        pid_t pid;
+        while (running > 0 && (pid = waitpid(-1, &status, flags)) > 0) {
+            for (uint32_t k = 0; k < shards; k++) {
+                if (workers[k] != pid) continue;
+                workers[k] = -1;
+                running--;
+                std::cout << "⚠️  Shard " << k << " exited ("
+                          << (WIFEXITED(status) ? "status " + std::to_string(WEXITSTATUS(status))
+                                                : "signal " + std::to_string(WTERMSIG(status)))
+                          << ")" << std::endl;
+            }
+        }
+    };
+    
+    auto next_reap = std::chrono::steady_clock::now();
+    auto next_report = next_reap + 10s;
+    while (!stop_requested && running > 0) {
+        if (coordinator.poll() == 0) {
+            coordinator.publish();  // Heartbeat, and gates that reopen with time (cooldown, new UTC day)
+            realtime::wait_until(realtime::clock::now() + 100us, config.busy_poll);
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_reap) {
+            reap(WNOHANG);
+            next_reap = now + 100ms;
+        }
+        if (now >= next_report) {
+            const PortfolioEngine& account = coordinator.portfolio();
+            std::cout << "🧭 Equity " << account.equity() << " | Day " << account.daily_pnl() << " | Open "
+                      << account.open_positions() << " | Entries " << coordinator.approvals() << " approved / "
+                      << coordinator.rejections() << " blocked | Trades " << coordinator.trades()
+                      << (account.halted() ? " | 🛑 HALTED" : "") << std::endl;
+            next_report = now + 10s;
+        }
+    }
+    
+    // Ask whoever is left to stop. Workers close their positions and save
+    // their logs first, so keep serving their rings until they have exited
+    for (pid_t pid : workers) {
+        if (pid > 0) kill(pid, SIGTERM);
+    }
+    auto deadline = std::chrono::steady_clock::now() + 60s;
+    while (running > 0 && std::chrono::steady_clock::now() < deadline) {
+        if (coordinator.poll() == 0) {
+            coordinator.publish();
+            std::this_thread::sleep_for(10ms);
+        }
+        reap(WNOHANG);
+    }
+    if (running > 0) {
+        std::cerr << "⚠️  " << running << " shard(s) did not stop within 60s - killing" << std::endl;
+        for (pid_t pid : workers) {
+            if (pid > 0) kill(pid, SIGKILL);
+        }
+        reap(0);
+    }
+    coordinator.poll();
+    
+    std::cout << "\n🧭 Account equity " << coordinator.portfolio().equity() << ", realized "
+              << coordinator.portfolio().realized_pnl() << ", " << coordinator.trades() << " trades from "
+              << shards << " shards" << std::endl;
+    coordinator.learning().print_summary();
+    coordinator.learning().save_to_file(config.trade_log_file);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Parse arguments
     BotConfig config;
@@ -232,17 +1032,107 @@ int main(int argc, char* argv[]) {
             std::cout << "🚨 WARNING: LIVE TRADING MODE" << std::endl;
         } else if (std::string(argv[i]) == "--learning-off") {
             config.enable_learning = false;
+        } else if (std::string(argv[i]) == "--no-record") {
+            config.record_ticks = false;
+        } else if (std::string(argv[i]) == "--no-stats") {
+            config.publish_stats = false;
+        } else if (std::string(argv[i]) == "--capture" && i + 1 < argc) {
+            config.capture_file = argv[++i];
+        } else if (std::string(argv[i]) == "--replay" && i + 1 < argc) {
+            config.replay_file = argv[++i];
+        } else if (std::string(argv[i]) == "--replay-speed" && i + 1 < argc) {
+            config.replay_speed = std::stod(argv[++i]);
+        } else if (std::string(argv[i]) == "--max-daily-loss" && i + 1 < argc) {
+            config.max_daily_loss_usd = std::stod(argv[++i]);
+        } else if (std::string(argv[i]) == "--max-losses" && i + 1 < argc) {
+            config.max_consecutive_losses = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--loss-cooldown" && i + 1 < argc) {
+            config.loss_cooldown_seconds = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--max-slippage" && i + 1 < argc) {
+            config.max_slippage_bps = std::stod(argv[++i]);
+        } else if (std::string(argv[i]) == "--threaded") {
+            config.threaded = true;
+        } else if (std::string(argv[i]) == "--cpus" && i + 1 < argc) {
+            // feed,strategy,execution,analytics
+            config.threaded = true;
+            int* cpus[] = {&config.feed_cpu, &config.strategy_cpu, &config.execution_cpu, &config.analytics_cpu};
+            std::string list = argv[++i];
+            size_t start = 0;
+            for (int* cpu : cpus) {
+                size_t end = list.find(',', start);
+                *cpu = std::stoi(list.substr(start, end - start));
+                if (end == std::string::npos) break;
+                start = end + 1;
+            }
+        } else if (std::string(argv[i]) == "--busy-poll") {
+            config.busy_poll = true;
+        } else if (std::string(argv[i]) == "--mlock") {
+            config.lock_memory = true;
+        } else if (std::string(argv[i]) == "--huge-pages") {
+            config.huge_pages = true;
+        } else if (std::string(argv[i]) == "--feed-interval" && i + 1 < argc) {
+            config.feed_interval_ms = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--async-feed") {
+            config.async_feed = true;
+        } else if (std::string(argv[i]) == "--max-positions" && i + 1 < argc) {
+            config.max_concurrent_trades = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--shards" && i + 1 < argc) {
+            config.shards = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--worker" && i + 1 < argc) {
+            config.worker = std::stoi(argv[++i]);
         } else if (std::string(argv[i]) == "--help") {
             std::cout << "\nUsage: kraken_bot [options]\n" << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  --live          Use live trading (default: paper)" << std::endl;
             std::cout << "  --learning-off  Disable self-learning" << std::endl;
+            std::cout << "  --no-record     Don't record tick history" << std::endl;
+            std::cout << "  --no-stats      Don't publish live stats to shared memory" << std::endl;
+            std::cout << "  --capture FILE  Record every REST exchange to a session log" << std::endl;
+            std::cout << "  --replay FILE   Re-run a captured session offline" << std::endl;
+            std::cout << "  --replay-speed X  Replay at X times real time (0 = max, default 10)" << std::endl;
+            std::cout << "  --max-daily-loss USD  Stop trading for the UTC day past this loss (default 500)" << std::endl;
+            std::cout << "  --max-losses N  Losing streak that starts a cooldown (default 3)" << std::endl;
+            std::cout << "  --loss-cooldown S  Cooldown length in seconds (default 300)" << std::endl;
+            std::cout << "  --max-slippage BPS  Skip entries whose estimated book slippage is higher (default 25)" << std::endl;
+            std::cout << "  --threaded      Dedicated feed/strategy/execution/analytics threads" << std::endl;
+            std::cout << "  --cpus F,S,E,A  Pin those threads to CPUs (implies --threaded)" << std::endl;
+            std::cout << "  --busy-poll     Feed/execution threads spin instead of sleeping" << std::endl;
+            std::cout << "  --mlock         Lock all process memory (mlockall)" << std::endl;
+            std::cout << "  --huge-pages    Back thread queues with huge pages" << std::endl;
+            std::cout << "  --feed-interval MS  Ticker poll period when threaded (default 1000)" << std::endl;
+            std::cout << "  --async-feed    Fetch ticker batches concurrently on an event loop" << std::endl;
+            std::cout << "  --max-positions N  Concurrent positions, account-wide (default 1)" << std::endl;
+            std::cout << "  --shards N      Risk coordinator + N worker processes, each trading its share of the pairs" << std::endl;
+            std::cout << "  --worker K      Run as shard worker K of a running coordinator (started by --shards)" << std::endl;
             std::cout << "  --help          Show this help\n" << std::endl;
             return 0;
         }
     }
     
+    // Replay never reaches Kraken; placeholder keys satisfy authenticate()
+    if (!config.replay_file.empty()) {
+        setenv("KRAKEN_API_KEY", "replay", 0);
+        setenv("KRAKEN_API_SECRET", "cmVwbGF5", 0);
+    }
+    
+    if (config.shards > 0 || config.worker >= 0) {
+        if (!config.replay_file.empty() || !config.capture_file.empty() || config.feed_cpu >= 0) {
+            std::cerr << "❌ --capture, --replay and --cpus are per process; not supported with --shards" << std::endl;
+            return 1;
+        }
+    }
+    if (config.worker >= 0) {
+        // Per-shard files; the coordinator writes the merged ones
+        config.trade_log_file = shard_file(config.trade_log_file, config.worker);
+        config.stats_segment += "_shard" + std::to_string(config.worker);
+    }
+    
     try {
+        if (config.shards > 0 && config.worker < 0) return run_sharded(config, argc, argv);
+        // Ctrl+C / SIGTERM end the session normally, so open tick blocks,
+        // segment footers and the trade log are written on the way out
+        std::signal(SIGINT, request_stop);
+        std::signal(SIGTERM, request_stop);
         KrakenTradingBot bot(config);
         bot.run();
     } catch (const std::exception& e) {
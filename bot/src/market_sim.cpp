@@ -0,0 +1,139 @@
+#include "market_sim.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    constexpr double SECONDS_PER_DAY = 86400.0;
+    constexpr double EWMA_WEIGHT = 0.03;  // Realised variance smoothing per tick
+}
+
+MarketSimulator::MarketSimulator(const MarketSimConfig& config)
+    : config(config), rng(config.seed) {
+    specs.resize(config.pairs);
+    state.resize(config.pairs);
+
+    auto log_uniform = [&](double lo, double hi) {
+        return std::exp(std::log(lo) + uniform(rng) * (std::log(hi) - std::log(lo)));
+    };
+
+    for (size_t i = 0; i < config.pairs; i++) {
+        PairState& s = state[i];
+        s.mid = log_uniform(0.05, 60000.0);
+        s.last_mid = s.mid;
+        s.sigma = log_uniform(config.min_daily_volatility_pct, config.max_daily_volatility_pct) / 100.0 /
+                  std::sqrt(SECONDS_PER_DAY);
+        s.ewma_var = s.sigma * s.sigma;
+        s.base_spread_bps = config.base_spread_bps * log_uniform(0.25, 4.0);
+        s.spread_bps = s.base_spread_bps;
+
+        // About six significant digits of price, like real Kraken pairs
+        char name[24];
+        std::snprintf(name, sizeof(name), "SIM%04zu", i + 1);
+        InstrumentSpec& spec = specs[i];
+        spec.base = name;
+        spec.pair = std::string(name) + "USD";
+        spec.pair_decimals = std::clamp(5 - static_cast<int>(std::floor(std::log10(s.mid))), 1, 8);
+        spec.lot_decimals = 8;
+        spec.ordermin = spec.qty_for_notional(Notional::from_double(5), spec.price_from_double(s.mid));
+    }
+}
+
+size_t MarketSimulator::advance(double dt_seconds, std::vector<SimTick>& out) {
+    clock_us += static_cast<int64_t>(dt_seconds * 1e6);
+    double sqrt_dt = std::sqrt(dt_seconds);
+    double drift = config.drift_per_day_pct / 100.0 / SECONDS_PER_DAY;
+    double burst_start = config.bursts_per_hour / 3600.0 * dt_seconds;
+    double burst_end = dt_seconds / config.burst_mean_seconds;
+    double jump_chance = config.jumps_per_day / SECONDS_PER_DAY * dt_seconds;
+    size_t emitted = 0;
+
+    for (size_t i = 0; i < state.size(); i++) {
+        PairState& s = state[i];
+
+        if (s.burst ? uniform(rng) < burst_end : uniform(rng) < burst_start) s.burst = !s.burst;
+        double activity = s.burst ? config.burst_multiplier : 1.0;
+
+        // GBM step; bursts scale variance with activity
+        double sigma = s.sigma * std::sqrt(activity);
+        double log_return = (drift - 0.5 * sigma * sigma) * dt_seconds + sigma * sqrt_dt * normal(rng);
+        if (uniform(rng) < jump_chance) {
+            log_return += config.jump_std_pct / 100.0 * normal(rng);
+            s.spread_bps *= config.jump_spread_multiplier;
+            s.jumped = true;
+        }
+        s.mid *= std::exp(log_return);
+
+        // Spread reverts to its (burst-widened) base in log space
+        double target = std::log(s.base_spread_bps * (s.burst ? 1.5 : 1.0));
+        double log_spread = std::log(s.spread_bps);
+        log_spread += config.spread_reversion_per_second * (target - log_spread) * dt_seconds +
+                      config.spread_vol * sqrt_dt * normal(rng);
+        s.spread_bps = std::clamp(std::exp(log_spread), 0.1, 500.0);
+
+        // At most one tick per pair per step - keep dt under 1 / rate
+        s.since_tick += dt_seconds;
+        if (uniform(rng) >= config.ticks_per_pair_per_second * activity * dt_seconds) continue;
+
+        double r = std::log(s.mid / s.last_mid);
+        s.ewma_var = (1 - EWMA_WEIGHT) * s.ewma_var + EWMA_WEIGHT * r * r / s.since_tick;
+        s.last_mid = s.mid;
+        s.since_tick = 0;
+
+        const InstrumentSpec& spec = specs[i];
+        SimTick tick;
+        tick.pair = static_cast<uint32_t>(i);
+        tick.time_us = clock_us;
+        tick.bid = bid(tick.pair);
+        tick.ask = ask(tick.pair);
+        tick.last = uniform(rng) < 0.5 ? tick.bid : tick.ask;
+        tick.volume = spec.qty_for_notional(Notional::from_double(500.0 * std::exp(normal(rng)) * activity),
+                                            spec.price_from_double(s.mid));
+        tick.jump = s.jumped;
+        tick.burst = s.burst;
+        s.jumped = false;
+        out.push_back(tick);
+        emitted++;
+    }
+    return emitted;
+}
+
+Price MarketSimulator::bid(uint32_t pair) const {
+    const PairState& s = state[pair];
+    return specs[pair].price_from_double(s.mid * (1 - s.spread_bps / 2e4));
+}
+
+Price MarketSimulator::ask(uint32_t pair) const {
+    const PairState& s = state[pair];
+    Price a = specs[pair].price_from_double(s.mid * (1 + s.spread_bps / 2e4));
+    Price b = bid(pair);
+    return a.ticks > b.ticks ? a : Price{b.ticks + 1};
+}
+
+double MarketSimulator::volatility_24h_pct(uint32_t pair) const {
+    return std::sqrt(state[pair].ewma_var * SECONDS_PER_DAY) * 100.0;
+}
+
+void MarketSimulator::build_book(uint32_t pair, OrderBookSet& books, OrderBookSet::BookSlot slot, size_t levels) {
+    const PairState& s = state[pair];
+    const InstrumentSpec& spec = specs[pair];
+    books.clear(slot);
+
+    Price best_bid = bid(pair);
+    Price best_ask = ask(pair);
+    int64_t step = std::max<int64_t>(1, static_cast<int64_t>(best_bid.ticks * 1e-4));  // ~1 bp apart
+    double thin = s.base_spread_bps / s.spread_bps * (s.burst ? 0.5 : 1.0);
+
+    for (size_t i = 0; i < levels; i++) {
+        double level_usd = config.book_depth_usd / 10.0 * thin * (1.0 + 0.3 * i);
+        int64_t offset = static_cast<int64_t>(i) * step;
+        Price bid_price{best_bid.ticks - offset};
+        Price ask_price{best_ask.ticks + offset};
+        if (bid_price.ticks > 0) {
+            books.set_level(slot, Side::Buy, bid_price,
+                            spec.qty_for_notional(Notional::from_double(level_usd * std::exp(0.3 * normal(rng))), bid_price));
+        }
+        books.set_level(slot, Side::Sell, ask_price,
+                        spec.qty_for_notional(Notional::from_double(level_usd * std::exp(0.3 * normal(rng))), ask_price));
+    }
+}
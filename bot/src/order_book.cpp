@@ -0,0 +1,337 @@
+#include "order_book.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+    constexpr std::array<uint32_t, 256> make_crc_table() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }
+    constexpr auto CRC_TABLE = make_crc_table();
+
+    // Bids ascend, asks descend: either way the best level sorts last
+    int64_t sort_key(Side side, int64_t ticks) {
+        return side == Side::Buy ? ticks : -ticks;
+    }
+
+    size_t side_index(Side side) { return static_cast<size_t>(side); }
+
+    int decimals_of(const json& value) {
+        if (!value.is_string()) return -1;
+        const std::string& text = value.get_ref<const std::string&>();
+        size_t dot = text.find('.');
+        return dot == std::string::npos ? 0 : static_cast<int>(text.size() - dot - 1);
+    }
+
+    const json* member(const json& object, const char* a, const char* b) {
+        if (auto it = object.find(a); it != object.end()) return &*it;
+        if (auto it = object.find(b); it != object.end()) return &*it;
+        return nullptr;
+    }
+}
+
+uint32_t OrderBookSet::crc32(const char* data, size_t length, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = CRC_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+OrderBookSet::OrderBookSet(size_t max_pairs, size_t depth)
+    : max_pairs(max_pairs), max_depth(std::max<size_t>(depth, CHECKSUM_LEVELS)),
+      arena(max_pairs * 2 * 2 * max_depth) {
+    books.reserve(max_pairs);
+}
+
+OrderBookSet::BookSlot OrderBookSet::slot_for(const InstrumentSpec& spec) {
+    if (auto it = names.find(spec.pair.view()); it != names.end()) return it->second;
+    if (books.size() >= max_pairs) {
+        throw std::length_error("OrderBookSet: no room for " + spec.pair.str() +
+                                " (max_pairs " + std::to_string(max_pairs) + ")");
+    }
+
+    Book book;
+    book.spec = &spec;
+    book.wire_price_decimals = static_cast<int8_t>(spec.pair_decimals);
+    book.wire_qty_decimals = static_cast<int8_t>(spec.lot_decimals);
+    BookSlot slot = static_cast<BookSlot>(books.size());
+    books.push_back(book);
+    names.emplace(spec.pair.str(), slot);
+    return slot;
+}
+
+void OrderBookSet::add_alias(std::string_view name, BookSlot slot) {
+    names.emplace(std::string(name), slot);
+}
+
+const OrderBookSet::BookSlot* OrderBookSet::find(std::string_view name) const {
+    auto it = names.find(name);
+    return it == names.end() ? nullptr : &it->second;
+}
+
+void OrderBookSet::set_level(BookSlot slot, Side side, Price price, Qty qty) {
+    Book& book = books[slot];
+    uint32_t& begin = book.begin[side_index(side)];
+    uint32_t& count = book.count[side_index(side)];
+    BookLevel* base = side_levels(slot, side);
+    BookLevel* first = base + begin;
+    BookLevel* last = first + count;
+
+    int64_t key = sort_key(side, price.ticks);
+    BookLevel* pos = std::lower_bound(first, last, key,
+        [side](const BookLevel& level, int64_t k) { return sort_key(side, level.ticks) < k; });
+    bool exists = pos != last && pos->ticks == price.ticks;
+
+    if (qty.lots == 0) {
+        if (exists) {
+            std::memmove(pos, pos + 1, (last - pos - 1) * sizeof(BookLevel));
+            count--;
+        }
+        return;
+    }
+    if (exists) {
+        pos->lots = qty.lots;
+        return;
+    }
+    if (count == max_depth && pos == first) return;  // Beyond the tracked depth
+
+    if (begin + count == 2 * max_depth) {
+        // Top reached the end of the side's room - slide the levels back down
+        std::memmove(base, first, count * sizeof(BookLevel));
+        pos -= begin;
+        last -= begin;
+        begin = 0;
+    }
+    std::memmove(pos + 1, pos, (last - pos) * sizeof(BookLevel));
+    *pos = {price.ticks, qty.lots};
+    count++;
+
+    if (count > max_depth) {
+        // Truncate like Kraken does: the worst level falls out of view
+        begin++;
+        count--;
+    }
+}
+
+void OrderBookSet::clear(BookSlot slot) {
+    Book& book = books[slot];
+    book.begin[0] = book.begin[1] = 0;
+    book.count[0] = book.count[1] = 0;
+    book.synced = false;
+}
+
+void OrderBookSet::apply_levels(BookSlot slot, Side side, const json& levels) {
+    const InstrumentSpec& spec = *books[slot].spec;
+    for (const auto& level : levels) {
+        Price price;
+        Qty qty;
+        if (level.is_array()) {
+            // REST / WS v1: ["price", "volume", "timestamp"(, "r")]
+            price = level[0].is_string() ? spec.parse_price(level[0].get_ref<const std::string&>())
+                                         : spec.price_from_double(level[0].get<double>());
+            qty = level[1].is_string() ? spec.parse_qty(level[1].get_ref<const std::string&>())
+                                       : Qty{std::llround(level[1].get<double>() * fixed_point::POW10[spec.lot_decimals])};
+        } else {
+            // WS v2: {"price": 0.5666, "qty": 4831.75496356}
+            price = spec.price_from_double(level.at("price").get<double>());
+            qty = Qty{std::llround(level.at("qty").get<double>() * fixed_point::POW10[spec.lot_decimals])};
+        }
+        set_level(slot, side, price, qty);
+    }
+}
+
+void OrderBookSet::apply_snapshot(BookSlot slot, const json& book_json) {
+    clear(slot);
+    Book& book = books[slot];
+    const InstrumentSpec& spec = *book.spec;
+    const json* asks = member(book_json, "asks", "as");
+    const json* bids = member(book_json, "bids", "bs");
+
+    // Remember the string precision for the checksum (never below the pair's)
+    book.wire_price_decimals = static_cast<int8_t>(spec.pair_decimals);
+    book.wire_qty_decimals = static_cast<int8_t>(spec.lot_decimals);
+    for (const json* side : {asks, bids}) {
+        if (!side || side->empty() || !(*side)[0].is_array()) continue;
+        book.wire_price_decimals = static_cast<int8_t>(std::max(spec.pair_decimals, decimals_of((*side)[0][0])));
+        book.wire_qty_decimals = static_cast<int8_t>(std::max(spec.lot_decimals, decimals_of((*side)[0][1])));
+        break;
+    }
+
+    if (asks) apply_levels(slot, Side::Sell, *asks);
+    if (bids) apply_levels(slot, Side::Buy, *bids);
+    book.synced = true;
+}
+
+bool OrderBookSet::apply_ws_message(const json& message) {
+    if (message.is_array()) return apply_v1(message);
+    if (message.is_object() && message.value("channel", "") == "book") return apply_v2(message);
+    return true;  // Heartbeats, status, other channels
+}
+
+bool OrderBookSet::apply_v1(const json& message) {
+    // [channelID, payload(, payload), "book-N", "XBT/USD"]
+    if (message.size() < 4 || !message[message.size() - 2].is_string()) return true;
+    if (message[message.size() - 2].get_ref<const std::string&>().rfind("book", 0) != 0) return true;
+    const BookSlot* found = find(message.back().get<std::string>());
+    if (!found) return false;
+    BookSlot slot = *found;
+
+    const json& first = message[1];
+    if (first.contains("as") || first.contains("bs")) {
+        apply_snapshot(slot, first);
+        return true;
+    }
+    if (!books[slot].synced) return false;  // Waiting for a fresh snapshot
+
+    const json* checksum_field = nullptr;
+    for (size_t i = 1; i + 2 < message.size(); i++) {
+        const json& payload = message[i];
+        if (auto it = payload.find("a"); it != payload.end()) apply_levels(slot, Side::Sell, *it);
+        if (auto it = payload.find("b"); it != payload.end()) apply_levels(slot, Side::Buy, *it);
+        if (auto it = payload.find("c"); it != payload.end()) checksum_field = &*it;
+    }
+    if (!checksum_field) return true;
+    return verify(slot, static_cast<uint32_t>(std::stoul(checksum_field->get<std::string>())));
+}
+
+bool OrderBookSet::apply_v2(const json& message) {
+    bool snapshot = message.value("type", "") == "snapshot";
+    bool ok = true;
+    for (const auto& entry : message.at("data")) {
+        const BookSlot* found = find(entry.at("symbol").get<std::string>());
+        if (!found) {
+            ok = false;
+            continue;
+        }
+        BookSlot slot = *found;
+        Book& book = books[slot];
+        if (snapshot) {
+            clear(slot);
+            book.wire_price_decimals = static_cast<int8_t>(book.spec->pair_decimals);
+            book.wire_qty_decimals = static_cast<int8_t>(book.spec->lot_decimals);
+            book.synced = true;
+        } else if (!book.synced) {
+            ok = false;
+            continue;
+        }
+        if (auto it = entry.find("asks"); it != entry.end()) apply_levels(slot, Side::Sell, *it);
+        if (auto it = entry.find("bids"); it != entry.end()) apply_levels(slot, Side::Buy, *it);
+        if (auto it = entry.find("checksum"); it != entry.end()) {
+            ok = verify(slot, it->get<uint32_t>()) && ok;
+        }
+    }
+    return ok;
+}
+
+bool OrderBookSet::verify(BookSlot slot, uint32_t expected) {
+    if (checksum(slot) == expected) return true;
+    books[slot].synced = false;
+    failures++;
+    return false;
+}
+
+uint32_t OrderBookSet::checksum(BookSlot slot) const {
+    const Book& book = books[slot];
+    const InstrumentSpec& spec = *book.spec;
+    int64_t price_scale = fixed_point::POW10[book.wire_price_decimals - spec.pair_decimals];
+    int64_t qty_scale = fixed_point::POW10[book.wire_qty_decimals - spec.lot_decimals];
+
+    // 20 levels x 2 numbers x at most 19 digits
+    char text[2 * CHECKSUM_LEVELS * 2 * 20];
+    char* out = text;
+    for (Side side : {Side::Sell, Side::Buy}) {
+        size_t n = std::min<size_t>(levels(slot, side), CHECKSUM_LEVELS);
+        for (size_t i = 0; i < n; i++) {
+            BookLevel l = level(slot, side, i);
+            out = std::to_chars(out, text + sizeof(text), l.ticks * price_scale).ptr;
+            out = std::to_chars(out, text + sizeof(text), l.lots * qty_scale).ptr;
+        }
+    }
+    return crc32(text, static_cast<size_t>(out - text));
+}
+
+Price OrderBookSet::best_bid(BookSlot slot) const {
+    return levels(slot, Side::Buy) ? Price{level(slot, Side::Buy, 0).ticks} : Price{};
+}
+
+Price OrderBookSet::best_ask(BookSlot slot) const {
+    return levels(slot, Side::Sell) ? Price{level(slot, Side::Sell, 0).ticks} : Price{};
+}
+
+size_t OrderBookSet::levels(BookSlot slot, Side side) const {
+    return books[slot].count[side_index(side)];
+}
+
+BookLevel OrderBookSet::level(BookSlot slot, Side side, size_t from_best) const {
+    const Book& book = books[slot];
+    size_t s = side_index(side);
+    return side_levels(slot, side)[book.begin[s] + book.count[s] - 1 - from_best];
+}
+
+template <typename Budget>
+FillEstimate OrderBookSet::walk(BookSlot slot, Side taker, Budget remaining) const {
+    const InstrumentSpec& spec = *books[slot].spec;
+    Side book_side = taker == Side::Buy ? Side::Sell : Side::Buy;
+    size_t n = levels(slot, book_side);
+
+    FillEstimate fill;
+    for (size_t i = 0; i < n; i++) {
+        BookLevel l = level(slot, book_side, i);
+        Price price{l.ticks};
+        Qty take{l.lots};
+        if constexpr (std::is_same_v<Budget, Notional>) {
+            Notional level_cost = spec.notional(price, take);
+            if (level_cost >= remaining) {
+                take = spec.qty_for_notional(remaining, price);
+                fill.complete = true;
+            }
+            remaining -= spec.notional(price, take);
+        } else {
+            if (take >= remaining) {
+                take = remaining;
+                fill.complete = true;
+            }
+            remaining = remaining - take;
+        }
+        fill.filled = fill.filled + take;
+        fill.cost += spec.notional(price, take);
+        fill.worst = price;
+        if (fill.complete) break;
+    }
+
+    if (fill.filled.lots > 0) {
+        fill.average_price = fill.cost.to_double() / spec.to_double(fill.filled);
+        double best = spec.to_double(Price{level(slot, book_side, 0).ticks});
+        double ratio = fill.average_price / best;
+        fill.slippage_bps = std::max(0.0, (taker == Side::Buy ? ratio - 1 : 1 - ratio) * 1e4);
+    }
+    return fill;
+}
+
+FillEstimate OrderBookSet::estimate_fill(BookSlot slot, Side taker, Notional budget) const {
+    return walk(slot, taker, budget);
+}
+
+FillEstimate OrderBookSet::estimate_fill(BookSlot slot, Side taker, Qty qty) const {
+    return walk(slot, taker, qty);
+}
+
+double OrderBookSet::imbalance(BookSlot slot, size_t depth_levels) const {
+    int64_t bid = 0, ask = 0;
+    size_t nb = std::min(depth_levels, levels(slot, Side::Buy));
+    size_t na = std::min(depth_levels, levels(slot, Side::Sell));
+    for (size_t i = 0; i < nb; i++) bid += level(slot, Side::Buy, i).lots;
+    for (size_t i = 0; i < na; i++) ask += level(slot, Side::Sell, i).lots;
+    if (bid + ask == 0) return 0;
+    return static_cast<double>(bid - ask) / static_cast<double>(bid + ask);
+}
@@ -0,0 +1,187 @@
+#include "portfolio.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    int64_t utc_day(std::chrono::system_clock::time_point t) {
+        return std::chrono::floor<std::chrono::days>(t).time_since_epoch().count();
+    }
+}
+
+const char* to_string(RiskVerdict verdict) {
+    switch (verdict) {
+        case RiskVerdict::Allowed: return "allowed";
+        case RiskVerdict::DailyLossLimit: return "daily loss limit";
+        case RiskVerdict::Cooldown: return "loss cooldown";
+        case RiskVerdict::MaxPositions: return "max positions";
+        case RiskVerdict::AssetExposure: return "asset exposure";
+        case RiskVerdict::GrossLeverage: return "gross leverage";
+        case RiskVerdict::Unreachable: return "risk coordinator unreachable";
+    }
+    return "unknown";
+}
+
+PortfolioEngine::PortfolioEngine(Notional starting_equity, RiskLimits limits)
+    : limits(limits), starting_equity(starting_equity),
+      day(utc_day(clock::now())), day_start_equity(starting_equity), day_peak_equity(starting_equity) {}
+
+PortfolioEngine::PairSlot PortfolioEngine::slot_for(const InstrumentSpec& spec) {
+    if (auto it = slot_index.find(spec.pair); it != slot_index.end()) return it->second;
+
+    // Pairs sharing a base asset (XBT/USD, XBT/EUR) share one exposure bucket
+    const Symbol& asset_key = spec.base.empty() ? spec.pair : spec.base;
+    auto [asset_it, added] = asset_index.try_emplace(asset_key, static_cast<uint32_t>(assets.size()));
+    if (added) assets.emplace_back();
+
+    Slot slot;
+    slot.spec = &spec;
+    slot.asset = asset_it->second;
+    PairSlot id = static_cast<PairSlot>(slots.size());
+    slots.push_back(slot);
+    slot_index.emplace(spec.pair, id);
+    return id;
+}
+
+RiskVerdict PortfolioEngine::entry_gate(clock::time_point now) {
+    roll_day(now);
+    if (day_halted) return RiskVerdict::DailyLossLimit;
+    if (now < cooldown_end) return RiskVerdict::Cooldown;
+    return RiskVerdict::Allowed;
+}
+
+RiskVerdict PortfolioEngine::check(PairSlot id, Side side, Price price, Qty volume, double leverage,
+                                   clock::time_point now) {
+    const Slot& slot = slots[id];
+    int64_t delta = side == Side::Buy ? volume.lots : -volume.lots;
+
+    // Closing or reducing is never blocked - that is how risk comes down
+    bool reduces = slot.lots != 0 && (slot.lots > 0) != (delta > 0) &&
+                   std::abs(delta) <= std::abs(slot.lots);
+    if (reduces) return RiskVerdict::Allowed;
+
+    RiskVerdict gate = entry_gate(now);
+    if (gate != RiskVerdict::Allowed) return gate;
+    if (slot.lots == 0 && open_count >= limits.max_positions) return RiskVerdict::MaxPositions;
+
+    Notional added = leverage_weighted(slot.spec->notional(price, volume), leverage);
+    if (assets[slot.asset].exposure + added > limits.max_asset_exposure) return RiskVerdict::AssetExposure;
+
+    Notional equity_now = equity();
+    if (equity_now.raw <= 0 ||
+        static_cast<double>((gross + added).raw) > limits.max_gross_leverage * static_cast<double>(equity_now.raw)) {
+        return RiskVerdict::GrossLeverage;
+    }
+    return RiskVerdict::Allowed;
+}
+
+void PortfolioEngine::on_fill(PairSlot id, Side side, Price price, Qty volume, double leverage) {
+    Slot& slot = slots[id];
+    const InstrumentSpec& spec = *slot.spec;
+    int64_t delta = side == Side::Buy ? volume.lots : -volume.lots;
+    if (delta == 0) return;
+
+    bool was_open = slot.lots != 0;
+    if (slot.lots != 0 && (slot.lots > 0) != (delta > 0)) {
+        // Reduce: realize the closed part against its share of the cost basis
+        int64_t closing = std::abs(delta) >= std::abs(slot.lots) ? slot.lots : -delta;
+        Notional closed_cost{static_cast<int64_t>(static_cast<__int128>(slot.cost.raw) * closing / slot.lots)};
+        Notional pnl = spec.notional(price, Qty{closing}) - closed_cost;
+        realized += pnl;
+        slot.cost -= closed_cost;
+        slot.lots -= closing;
+        delta += closing;
+        if (slot.lots == 0) slot.cost = Notional{};
+    }
+    if (delta != 0) {
+        // Open or add (also the remainder of a fill that flipped the side)
+        if (slot.lots == 0) slot.entry = price;
+        slot.cost += spec.notional(price, Qty{delta});
+        slot.lots += delta;
+        slot.leverage = leverage;
+    }
+
+    bool is_open = slot.lots != 0;
+    if (is_open != was_open) open_count += is_open ? 1 : -1;
+    remark(slot, price);
+}
+
+void PortfolioEngine::on_mark(PairSlot id, Price mark) {
+    Slot& slot = slots[id];
+    if (slot.lots == 0) {
+        slot.mark = mark;
+        return;
+    }
+    remark(slot, mark);
+}
+
+void PortfolioEngine::charge_fee(Notional fee) {
+    realized -= fee;
+    update_equity();
+}
+
+void PortfolioEngine::on_trade_closed(Notional net_pnl, clock::time_point now) {
+    roll_day(now);
+    if (net_pnl.raw >= 0) {
+        loss_streak = 0;
+        return;
+    }
+    if (++loss_streak >= limits.max_consecutive_losses) {
+        cooldown_end = now + limits.loss_cooldown;
+        loss_streak = 0;
+    }
+}
+
+std::vector<Position> PortfolioEngine::positions() const {
+    std::vector<Position> open;
+    open.reserve(open_count);
+    for (const Slot& slot : slots) {
+        if (slot.lots == 0) continue;
+        Position p;
+        p.pair = slot.spec->pair;
+        p.size = Qty{slot.lots};
+        p.entry_price = slot.entry;
+        p.leverage = slot.leverage;
+        p.current_price = slot.mark;
+        p.unrealized_pnl = slot.upnl;
+        open.push_back(p);
+    }
+    return open;
+}
+
+// Swap the slot's old contribution to the running sums for its new one
+void PortfolioEngine::remark(Slot& slot, Price mark) {
+    Notional old_upnl = slot.upnl;
+    Notional old_weighted = slot.weighted;
+
+    slot.mark = mark;
+    slot.value = slot.spec->notional(mark, Qty{slot.lots});
+    slot.upnl = slot.value - slot.cost;
+    slot.weighted = leverage_weighted(slot.value, slot.leverage);
+
+    unrealized += slot.upnl - old_upnl;
+    assets[slot.asset].exposure += slot.weighted - old_weighted;
+    gross += slot.weighted - old_weighted;
+    update_equity();
+}
+
+void PortfolioEngine::update_equity() {
+    Notional now = equity();
+    day_peak_equity = std::max(day_peak_equity, now);
+    day_max_drawdown = std::max(day_max_drawdown, day_peak_equity - now);
+    if (day_start_equity - now >= limits.max_daily_loss) day_halted = true;
+}
+
+// New UTC day: fresh loss budget and drawdown baseline from current equity
+void PortfolioEngine::roll_day(clock::time_point now) {
+    int64_t today = utc_day(now);
+    if (today == day) return;
+    day = today;
+    day_start_equity = equity();
+    day_peak_equity = day_start_equity;
+    day_max_drawdown = Notional{};
+    day_halted = false;
+}
+
+Notional PortfolioEngine::leverage_weighted(Notional value, double leverage) {
+    return {std::llround(static_cast<double>(std::abs(value.raw)) * leverage)};
+}
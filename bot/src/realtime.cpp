@@ -0,0 +1,117 @@
+#include "realtime.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace realtime {
+
+bool pin_current_thread(int cpu, const char* name) {
+    pthread_setname_np(pthread_self(), name);  // Shows up in top -H / perf
+    if (cpu < 0) return true;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        std::cerr << "  ⚠️  Cannot pin " << name << " to CPU " << cpu << ": " << std::strerror(rc) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool lock_process_memory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "  ⚠️  mlockall failed: " << std::strerror(errno)
+                  << " (raise ulimit -l or grant CAP_IPC_LOCK)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace realtime
+
+// ---- JitterStats ----
+
+size_t JitterStats::bucket_for(uint64_t ns) {
+    // Values below 2^SUB_BITS get exact buckets; above, the top SUB_BITS
+    // bits under the leading one pick the sub-bucket
+    if (ns < (1u << SUB_BITS)) return ns;
+    int msb = std::bit_width(ns) - 1;
+    size_t sub = (ns >> (msb - SUB_BITS)) & ((1u << SUB_BITS) - 1);
+    return (static_cast<size_t>(msb - SUB_BITS + 1) << SUB_BITS) + sub;
+}
+
+uint64_t JitterStats::bucket_upper(size_t bucket) {
+    if (bucket < (1u << SUB_BITS)) return bucket + 1;
+    int msb = static_cast<int>(bucket >> SUB_BITS) + SUB_BITS - 1;
+    uint64_t sub = bucket & ((1u << SUB_BITS) - 1);
+    return ((1ull << SUB_BITS) + sub + 1) << (msb - SUB_BITS);
+}
+
+void JitterStats::record(std::chrono::nanoseconds late) {
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(late.count(), 0));
+    buckets[std::min(bucket_for(ns), BUCKETS - 1)]++;
+    samples++;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+double JitterStats::percentile_us(double q) const {
+    if (samples == 0) return 0;
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * samples)));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target) return std::min(bucket_upper(b), max_ns) / 1000.0;
+    }
+    return max_us();
+}
+
+std::string JitterStats::summary() const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "n=%llu p50=%.1f p99=%.1f p99.9=%.1f max=%.1f us",
+                  static_cast<unsigned long long>(samples), percentile_us(0.50), percentile_us(0.99),
+                  percentile_us(0.999), max_us());
+    return line;
+}
+
+// ---- HugePageBuffer ----
+
+HugePageBuffer::HugePageBuffer(size_t size, bool huge_pages) {
+    constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+    bytes = std::max<size_t>(size, 1);
+
+    if (huge_pages) {
+        size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            memory = p;
+            bytes = rounded;
+            huge = true;
+            return;
+        }
+        // No reserved hugetlbfs pages - ask for transparent huge pages instead
+        bytes = rounded;
+    }
+
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    memory = p;
+    if (huge_pages) huge = madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+
+    // Touch every page now so the hot path never takes a page fault
+    for (size_t off = 0; off < bytes; off += 4096) static_cast<volatile char*>(memory)[off] = 0;
+}
+
+HugePageBuffer::~HugePageBuffer() {
+    if (memory) munmap(memory, bytes);
+}
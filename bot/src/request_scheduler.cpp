@@ -0,0 +1,503 @@
+#include "request_scheduler.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <set>
+#include <string_view>
+
+namespace {
+    bool ends_with(std::string_view text, std::string_view suffix) {
+        return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+    }
+
+    constexpr double CANCEL_COST_HORIZON = 300;  // Seconds after which cancel_cost() is 0
+}
+
+// ---------------------------------------------------------------------------
+// DecayCounter
+// ---------------------------------------------------------------------------
+
+DecayCounter::DecayCounter(double max_count, double decay_per_sec)
+    : max(max_count), decay_rate(decay_per_sec), last_update(clock::now()) {}
+
+void DecayCounter::decay(clock::time_point now) {
+    if (now <= last_update) return;
+    double elapsed = std::chrono::duration<double>(now - last_update).count();
+    count = std::max(0.0, count - elapsed * decay_rate);
+    last_update = now;
+}
+
+double DecayCounter::wait_seconds(double cost, clock::time_point now) {
+    decay(now);
+    double over = count + cost - max;
+    if (over <= 0) return 0;
+    if (decay_rate <= 0) return 1.0;
+    return over / decay_rate;
+}
+
+void DecayCounter::consume(double cost, clock::time_point now) {
+    decay(now);
+    count += cost;
+}
+
+void DecayCounter::saturate(clock::time_point now) {
+    decay(now);
+    count = max;
+}
+
+double DecayCounter::level(clock::time_point now) {
+    decay(now);
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// RateLimitConfig
+// ---------------------------------------------------------------------------
+
+RateLimitConfig RateLimitConfig::for_tier(RateLimitTier tier) {
+    RateLimitConfig config;
+    switch (tier) {
+        case RateLimitTier::Starter:
+            config.api_counter_max = 15;
+            config.api_decay_per_sec = 0.33;
+            config.order_counter_max = 60;
+            config.order_decay_per_sec = 1.0;
+            break;
+        case RateLimitTier::Intermediate:
+            config.api_counter_max = 20;
+            config.api_decay_per_sec = 0.5;
+            config.order_counter_max = 125;
+            config.order_decay_per_sec = 2.34;
+            break;
+        case RateLimitTier::Pro:
+            config.api_counter_max = 20;
+            config.api_decay_per_sec = 1.0;
+            config.order_counter_max = 180;
+            config.order_decay_per_sec = 3.75;
+            break;
+    }
+    return config;
+}
+
+// ---------------------------------------------------------------------------
+// RequestScheduler
+// ---------------------------------------------------------------------------
+
+RequestScheduler::RequestScheduler(Transport transport, const RateLimitConfig& config)
+    : transport(std::make_shared<const Transport>(std::move(transport))),
+      config(config),
+      api_counter(config.api_counter_max * config.headroom, config.api_decay_per_sec),
+      public_counter(config.public_counter_max * config.headroom, config.public_decay_per_sec) {
+    for (int l = 0; l < 2; l++) lanes[l].thread = std::thread(&RequestScheduler::lane_loop, this, l);
+    dispatcher = std::thread(&RequestScheduler::dispatch_loop, this);
+}
+
+void RequestScheduler::wrap_transport(const std::function<Transport(Transport)>& wrapper) {
+    std::lock_guard<std::mutex> lock(mutex);
+    transport = std::make_shared<const Transport>(wrapper(*transport));
+}
+
+void RequestScheduler::set_time_scale(double scale) {
+    if (scale <= 0) throw std::invalid_argument("Time scale must be positive");
+    std::lock_guard<std::mutex> lock(mutex);
+    double factor = scale / time_scale;
+    time_scale = scale;
+    config.api_decay_per_sec *= factor;
+    config.order_decay_per_sec *= factor;
+    config.public_decay_per_sec *= factor;
+    api_counter = DecayCounter(config.api_counter_max * config.headroom, config.api_decay_per_sec);
+    public_counter = DecayCounter(config.public_counter_max * config.headroom, config.public_decay_per_sec);
+    order_counters.clear();
+}
+
+void RequestScheduler::share_limits(uint32_t processes) {
+    if (processes == 0) throw std::invalid_argument("Process count must be positive");
+    std::lock_guard<std::mutex> lock(mutex);
+    double share = 1.0 / processes;
+    config.api_counter_max = std::max(config.api_counter_max * share, 2.0 / config.headroom);  // Ledgers cost 2
+    config.api_decay_per_sec *= share;
+    config.public_counter_max = std::max(config.public_counter_max * share, 1.0 / config.headroom);
+    config.public_decay_per_sec *= share;
+    api_counter = DecayCounter(config.api_counter_max * config.headroom, config.api_decay_per_sec);
+    public_counter = DecayCounter(config.public_counter_max * config.headroom, config.public_decay_per_sec);
+}
+
+RequestScheduler::~RequestScheduler() {
+    stop();
+}
+
+void RequestScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_all();
+    if (dispatcher.joinable()) dispatcher.join();
+    // Lanes finish the call they are running, if any
+    for (auto& lane : lanes) {
+        lane.cv.notify_all();
+        if (lane.thread.joinable()) lane.thread.join();
+    }
+
+    // Fail anything still queued so callers don't block forever
+    auto stopped = std::make_exception_ptr(std::runtime_error("Request scheduler stopped"));
+    for (auto& queue : queues) {
+        for (auto& pending : queue) pending.promise.set_exception(stopped);
+        queue.clear();
+    }
+    for (auto& [pair, pending] : pending_tickers) pending.promise.set_exception(stopped);
+    pending_tickers.clear();
+    ticker_order.clear();
+}
+
+std::shared_future<json> RequestScheduler::submit(ApiRequest request) {
+    Pending pending;
+    pending.request = std::move(request);
+    pending.future = pending.promise.get_future().share();
+    auto future = pending.future;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) throw std::runtime_error("Request scheduler stopped");
+        apply_costs(pending.request);
+        queues[static_cast<int>(pending.request.priority)].push_back(std::move(pending));
+    }
+    cv.notify_one();
+    return future;
+}
+
+std::shared_future<json> RequestScheduler::ticker(const std::string& pair) {
+    std::shared_future<json> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) throw std::runtime_error("Request scheduler stopped");
+
+        auto it = pending_tickers.find(pair);
+        if (it != pending_tickers.end()) {
+            stats.coalesced++;
+            return it->second.future;
+        }
+
+        PendingTicker pending;
+        pending.future = pending.promise.get_future().share();
+        future = pending.future;
+        pending_tickers.emplace(pair, std::move(pending));
+        ticker_order.push_back(pair);
+    }
+    cv.notify_one();
+    return future;
+}
+
+double RequestScheduler::admit(ApiRequest& request) {
+    // Retry interval while queued work or the private lane goes first
+    constexpr double YIELD_WAIT = 0.005;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) throw std::runtime_error("Request scheduler stopped");
+    apply_costs(request);
+    auto now = DecayCounter::clock::now();
+    DecayCounter& counter = counter_for(request);
+    if (request.cost > counter.max_count()) {
+        throw std::invalid_argument(request.endpoint + ": cost " + std::to_string(request.cost) +
+                                    " exceeds the rate limit counter (" + std::to_string(counter.max_count()) + ")");
+    }
+
+    double wait = counter.wait_seconds(request.cost, now);
+    // Queued work of the same or higher priority on this counter goes first
+    for (int p = 0; p <= static_cast<int>(request.priority); p++) {
+        if (!queues[p].empty() && &counter_for(queues[p].front().request) == &counter) wait = std::max(wait, YIELD_WAIT);
+    }
+    if (!request.is_private && !ticker_order.empty() && &counter == &public_counter) wait = std::max(wait, YIELD_WAIT);
+    if (request.is_private && lanes[PRIVATE_LANE].busy) wait = std::max(wait, YIELD_WAIT);
+    if (wait > 0) return wait;
+
+    counter.consume(request.cost, now);
+    if (request.is_private) lanes[PRIVATE_LANE].busy = true;
+    stats.dispatched++;
+    return 0;
+}
+
+void RequestScheduler::release(const ApiRequest& request, const json& result) {
+    remember_orders(request, result);
+    if (!request.is_private) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lanes[PRIVATE_LANE].busy = false;
+    }
+    cv.notify_one();
+}
+
+void RequestScheduler::release(const ApiRequest& request, const std::exception& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        on_transport_error(error, counter_for(request));
+        if (request.is_private) lanes[PRIVATE_LANE].busy = false;
+    }
+    cv.notify_one();
+}
+
+void RequestScheduler::set_pair_aliases(const std::map<std::string, std::string>& aliases) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pair_aliases = aliases;
+}
+
+double RequestScheduler::cancel_cost(double order_age_seconds) {
+    // Kraken's cancel penalty shrinks as the order ages
+    if (order_age_seconds < 5) return 8;
+    if (order_age_seconds < 10) return 6;
+    if (order_age_seconds < 15) return 5;
+    if (order_age_seconds < 45) return 4;
+    if (order_age_seconds < 90) return 2;
+    if (order_age_seconds < 300) return 1;
+    return 0;
+}
+
+double RequestScheduler::counter_level(const ApiRequest& request) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counter_for(request).level(DecayCounter::clock::now());
+}
+
+// Endpoint-specific costs Kraken charges regardless of what the caller set
+void RequestScheduler::apply_costs(ApiRequest& request) {
+    if (request.is_private && (ends_with(request.endpoint, "/Ledgers") || ends_with(request.endpoint, "/QueryLedgers") ||
+                               ends_with(request.endpoint, "/TradesHistory") || ends_with(request.endpoint, "/QueryTrades"))) {
+        request.cost = 2;
+    } else if (ends_with(request.endpoint, "/CancelOrder")) {
+        request.priority = RequestPriority::Order;
+        auto txid = request.params.find("txid");
+        if (txid == request.params.end() || !txid->is_string()) return;
+        auto it = placed_orders.find(txid->get<std::string>());
+        if (it == placed_orders.end()) return;
+        // Ages run on replay time like the counters do
+        double age = std::chrono::duration<double>(DecayCounter::clock::now() - it->second.placed).count() * time_scale;
+        request.cost = cancel_cost(age);
+        if (request.pair.empty()) request.pair = it->second.pair;
+        placed_orders.erase(it);
+    }
+}
+
+void RequestScheduler::remember_orders(const ApiRequest& request, const json& result) {
+    if (!ends_with(request.endpoint, "/AddOrder") || !result.is_object()) return;
+    auto txids = result.find("txid");
+    if (txids == result.end() || !txids->is_array()) return;
+
+    std::string pair = request.pair;
+    if (pair.empty() && request.params.contains("pair") && request.params["pair"].is_string()) {
+        pair = request.params["pair"].get<std::string>();
+    }
+    auto now = DecayCounter::clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    // Orders past the horizon cancel for free anyway
+    std::erase_if(placed_orders, [&](const auto& entry) {
+        return std::chrono::duration<double>(now - entry.second.placed).count() * time_scale >= CANCEL_COST_HORIZON;
+    });
+    for (const auto& txid : *txids) {
+        if (txid.is_string()) placed_orders[txid.get<std::string>()] = {pair, now};
+    }
+}
+
+SchedulerStats RequestScheduler::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+DecayCounter& RequestScheduler::counter_for(const ApiRequest& request) {
+    if (request.priority == RequestPriority::Order && !request.pair.empty()) {
+        auto it = order_counters.find(request.pair);
+        if (it == order_counters.end()) {
+            it = order_counters.emplace(request.pair,
+                DecayCounter(config.order_counter_max * config.headroom,
+                             config.order_decay_per_sec)).first;
+        }
+        return it->second;
+    }
+    return request.is_private ? api_counter : public_counter;
+}
+
+void RequestScheduler::dispatch_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (running) {
+        auto now = DecayCounter::clock::now();
+        double min_wait = -1;
+        // Counters a higher-priority request is waiting on; lower classes
+        // must not drain them or orders could starve behind market data
+        std::set<DecayCounter*> blocked;
+
+        Pending* ready = nullptr;
+        int ready_class = -1;
+        bool ticker_ready = false;
+
+        bool rejected = false;
+
+        for (int p = 0; p < 3 && !ready && !ticker_ready && !rejected; p++) {
+            if (!queues[p].empty()) {
+                auto& front = queues[p].front();
+                DecayCounter& counter = counter_for(front.request);
+                if (front.request.cost > counter.max_count()) {
+                    // Would wait forever - fail it instead
+                    front.promise.set_exception(std::make_exception_ptr(std::invalid_argument(
+                        front.request.endpoint + ": cost " + std::to_string(front.request.cost) +
+                        " exceeds the rate limit counter (" + std::to_string(counter.max_count()) + ")")));
+                    queues[p].pop_front();
+                    rejected = true;
+                    break;
+                }
+                double wait = counter.wait_seconds(front.request.cost, now);
+                bool lane_free = !lanes[front.request.is_private ? PRIVATE_LANE : PUBLIC_LANE].busy;
+                if (wait <= 0 && !blocked.count(&counter) && lane_free) {
+                    ready = &front;
+                    ready_class = p;
+                    break;
+                }
+                blocked.insert(&counter);
+                if (wait > 0 && (min_wait < 0 || wait < min_wait)) min_wait = wait;
+            }
+
+            if (p == static_cast<int>(RequestPriority::MarketData) && !ticker_order.empty()) {
+                double wait = public_counter.wait_seconds(1.0, now);
+                if (wait <= 0 && !blocked.count(&public_counter) && !lanes[PUBLIC_LANE].busy) {
+                    ticker_ready = true;
+                } else if (wait > 0 && (min_wait < 0 || wait < min_wait)) {
+                    min_wait = wait;
+                }
+            }
+        }
+
+        if (rejected) continue;
+
+        if (ready) {
+            Job job;
+            job.request.emplace(std::move(*ready));
+            queues[ready_class].pop_front();
+            counter_for(job.request->request).consume(job.request->request.cost, now);
+            stats.dispatched++;
+
+            Lane& lane = lanes[job.request->request.is_private ? PRIVATE_LANE : PUBLIC_LANE];
+            lane.busy = true;
+            lane.jobs.push_back(std::move(job));
+            lane.cv.notify_one();
+            continue;
+        }
+
+        if (ticker_ready) {
+            Job job;
+            while (!ticker_order.empty() && job.tickers.size() < config.max_ticker_batch) {
+                std::string pair = std::move(ticker_order.front());
+                ticker_order.pop_front();
+                auto it = pending_tickers.find(pair);
+                job.tickers.emplace_back(pair, std::move(it->second));
+                pending_tickers.erase(it);
+            }
+            public_counter.consume(1.0, now);
+            stats.dispatched++;
+            stats.ticker_batches++;
+            stats.ticker_pairs_batched += job.tickers.size();
+
+            Lane& lane = lanes[PUBLIC_LANE];
+            lane.busy = true;
+            lane.jobs.push_back(std::move(job));
+            lane.cv.notify_one();
+            continue;
+        }
+
+        // Woken by new work, a finished lane, or the counters draining
+        if (min_wait < 0) {
+            cv.wait(lock);
+        } else {
+            auto wait_start = DecayCounter::clock::now();
+            cv.wait_for(lock, std::chrono::duration<double>(min_wait));
+            stats.total_wait_seconds += std::chrono::duration<double>(DecayCounter::clock::now() - wait_start).count();
+        }
+    }
+}
+
+void RequestScheduler::lane_loop(int index) {
+    Lane& lane = lanes[index];
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        lane.cv.wait(lock, [&] { return !lane.jobs.empty() || !running; });
+        if (lane.jobs.empty()) return;
+
+        Job job = std::move(lane.jobs.front());
+        lane.jobs.pop_front();
+        std::shared_ptr<const Transport> send = transport;
+
+        lock.unlock();
+        if (job.request) {
+            execute(*job.request, *send);
+        } else {
+            execute_ticker_batch(job.tickers, *send);
+        }
+        lock.lock();
+
+        lane.busy = false;
+        cv.notify_one();
+    }
+}
+
+void RequestScheduler::execute(Pending& pending, const Transport& send) {
+    try {
+        json result = send(pending.request.endpoint, pending.request.params, pending.request.is_private);
+        remember_orders(pending.request, result);
+        pending.promise.set_value(std::move(result));
+    } catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            on_transport_error(e, counter_for(pending.request));
+        }
+        pending.promise.set_exception(std::current_exception());
+    }
+}
+
+void RequestScheduler::execute_ticker_batch(std::vector<std::pair<std::string, PendingTicker>>& batch,
+                                            const Transport& send) {
+    std::string pair_list;
+    for (const auto& [pair, pending] : batch) {
+        if (!pair_list.empty()) pair_list += ",";
+        pair_list += pair;
+    }
+
+    json result;
+    try {
+        result = send("/0/public/Ticker", json{{"pair", pair_list}}, false);
+    } catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            on_transport_error(e, public_counter);
+        }
+        auto error = std::current_exception();
+        for (auto& [pair, pending] : batch) pending.promise.set_exception(error);
+        return;
+    }
+
+    std::map<std::string, std::string> aliases;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        aliases = pair_aliases;
+    }
+
+    for (auto& [pair, pending] : batch) {
+        auto alias = aliases.find(pair);
+        const std::string& key = alias != aliases.end() ? alias->second : pair;
+
+        if (result.contains(key)) {
+            pending.promise.set_value(result[key]);
+        } else if (batch.size() == 1 && result.size() == 1) {
+            pending.promise.set_value(result.begin().value());
+        } else {
+            pending.promise.set_exception(std::make_exception_ptr(
+                std::runtime_error("Ticker: no data for " + pair)));
+        }
+    }
+}
+
+void RequestScheduler::on_transport_error(const std::exception& e, DecayCounter& counter) {
+    // Our model drifted from the exchange's - back off until the counter drains
+    std::string message = e.what();
+    if (message.find("Rate limit") != std::string::npos ||
+        message.find("Too many requests") != std::string::npos) {
+        counter.saturate(DecayCounter::clock::now());
+        stats.rate_limit_errors++;
+    }
+}
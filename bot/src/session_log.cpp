@@ -0,0 +1,185 @@
+#include "session_log.hpp"
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+namespace {
+    int64_t wall_now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+// ---- Capture ----
+
+SessionRecorder::SessionRecorder(const std::string& path) : started(clock::now()) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("Cannot create session log " + path + ": " + std::strerror(errno));
+
+    session_format::FileHeader header;
+    header.started_wall_us = wall_now_us();
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        throw std::runtime_error("Cannot write session log " + path);
+    }
+    std::fflush(file);
+}
+
+SessionRecorder::~SessionRecorder() {
+    if (file) std::fclose(file);
+}
+
+RequestScheduler::Transport SessionRecorder::wrap(RequestScheduler::Transport inner) {
+    return [self = shared_from_this(), inner = std::move(inner)](const std::string& endpoint, const json& params,
+                                                                 bool is_private) {
+        RecordedExchange exchange;
+        exchange.endpoint = endpoint;
+        exchange.params = params;
+        exchange.is_private = is_private;
+
+        auto begin = clock::now();
+        exchange.start_us = std::chrono::duration_cast<std::chrono::microseconds>(begin - self->started).count();
+        try {
+            json result = inner(endpoint, params, is_private);
+            exchange.latency_us = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - begin).count());
+            exchange.result = result;
+            self->append(exchange);
+            return result;
+        } catch (const std::exception& e) {
+            exchange.latency_us = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - begin).count());
+            exchange.is_error = true;
+            exchange.error = e.what();
+            self->append(exchange);
+            throw;
+        }
+    };
+}
+
+void SessionRecorder::append(const RecordedExchange& exchange) {
+    std::vector<uint8_t> params = json::to_cbor(exchange.params);
+    std::vector<uint8_t> body;
+    if (exchange.is_error) body.assign(exchange.error.begin(), exchange.error.end());
+    else body = json::to_cbor(exchange.result);
+
+    session_format::RecordHeader header;
+    header.start_us = exchange.start_us;
+    header.latency_us = exchange.latency_us;
+    header.is_private = exchange.is_private;
+    header.is_error = exchange.is_error;
+    header.endpoint_len = static_cast<uint16_t>(exchange.endpoint.size());
+    header.params_len = static_cast<uint32_t>(params.size());
+    header.body_len = static_cast<uint32_t>(body.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(exchange.endpoint.data(), 1, exchange.endpoint.size(), file);
+    std::fwrite(params.data(), 1, params.size(), file);
+    std::fwrite(body.data(), 1, body.size(), file);
+    std::fflush(file);
+    recorded++;
+}
+
+uint64_t SessionRecorder::exchanges() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+// ---- Replay ----
+
+std::vector<RecordedExchange> SessionReplayer::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) throw std::runtime_error("Cannot open session log " + path + ": " + std::strerror(errno));
+
+    session_format::FileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != session_format::FILE_MAGIC || header.version != session_format::VERSION) {
+        std::fclose(file);
+        throw std::runtime_error("Not a session log: " + path);
+    }
+
+    std::vector<RecordedExchange> exchanges;
+    session_format::RecordHeader record;
+    std::vector<uint8_t> params, body;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        RecordedExchange exchange;
+        exchange.start_us = record.start_us;
+        exchange.latency_us = record.latency_us;
+        exchange.is_private = record.is_private;
+        exchange.is_error = record.is_error;
+        exchange.endpoint.resize(record.endpoint_len);
+        params.resize(record.params_len);
+        body.resize(record.body_len);
+
+        // A capture cut short by a crash ends in a partial record - drop it
+        if (std::fread(exchange.endpoint.data(), 1, record.endpoint_len, file) != record.endpoint_len ||
+            std::fread(params.data(), 1, params.size(), file) != params.size() ||
+            std::fread(body.data(), 1, body.size(), file) != body.size()) {
+            break;
+        }
+
+        exchange.params = json::from_cbor(params);
+        if (exchange.is_error) exchange.error.assign(body.begin(), body.end());
+        else exchange.result = json::from_cbor(body);
+        exchanges.push_back(std::move(exchange));
+    }
+    std::fclose(file);
+    return exchanges;
+}
+
+SessionReplayer::SessionReplayer(const std::string& path, double speed)
+    : exchanges(load(path)), replay_speed(speed) {
+    for (size_t i = 0; i < exchanges.size(); i++) {
+        pending_by_endpoint[exchanges[i].endpoint].push_back(i);
+    }
+}
+
+RequestScheduler::Transport SessionReplayer::transport() {
+    return [self = shared_from_this()](const std::string& endpoint, const json& params, bool) {
+        return self->answer(endpoint, params);
+    };
+}
+
+size_t SessionReplayer::remaining() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t n = 0;
+    for (const auto& [endpoint, queue] : pending_by_endpoint) n += queue.size();
+    return n;
+}
+
+json SessionReplayer::answer(const std::string& endpoint, const json& params) {
+    const RecordedExchange* exchange = nullptr;
+    clock::time_point release;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) {
+            started = true;
+            replay_start = clock::now();
+        }
+
+        auto it = pending_by_endpoint.find(endpoint);
+        if (it == pending_by_endpoint.end() || it->second.empty()) {
+            throw ReplayExhausted("Replay: no recorded response left for " + endpoint);
+        }
+
+        auto& queue = it->second;
+        auto window_end = queue.begin() + std::min(queue.size(), MATCH_WINDOW);
+        auto match = std::find_if(queue.begin(), window_end,
+            [&](size_t i) { return exchanges[i].params == params; });
+        if (match == window_end) match = queue.begin();
+        exchange = &exchanges[*match];
+        queue.erase(match);
+
+        int64_t done_us = exchange->start_us + exchange->latency_us;
+        release = replay_start;
+        if (replay_speed > 0) {
+            release += std::chrono::microseconds(static_cast<int64_t>(done_us / replay_speed));
+        }
+    }
+
+    std::this_thread::sleep_until(release);
+    if (exchange->is_error) throw std::runtime_error(exchange->error);
+    return exchange->result;
+}
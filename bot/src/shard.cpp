@@ -0,0 +1,417 @@
+#include "shard.hpp"
+#include "stats_shm.hpp"
+#include "realtime.hpp"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Both sides map the same bytes; keep everything plain data
+static_assert(std::is_trivially_copyable_v<ShardMessage>);
+static_assert(std::is_trivially_copyable_v<ShardHeader>);
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+static_assert(std::atomic_ref<int64_t>::is_always_lock_free);
+static_assert(std::atomic_ref<uint32_t>::is_always_lock_free);
+static_assert((shard_layout::RING_CAPACITY & (shard_layout::RING_CAPACITY - 1)) == 0);
+
+namespace {
+    constexpr auto HEARTBEAT_TIMEOUT = std::chrono::seconds(3);
+
+    int64_t steady_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int64_t system_us(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+    }
+
+    size_t lanes_offset() {
+        return (sizeof(ShardHeader) + 63) & ~size_t{63};
+    }
+
+    size_t segment_bytes(uint32_t shards) {
+        return lanes_offset() + static_cast<size_t>(shards) * sizeof(ShardLane);
+    }
+
+    template <typename T>
+    void store(T& field, T value) {
+        std::atomic_ref<T>(field).store(value, std::memory_order_release);
+    }
+
+    template <typename T>
+    T load(const T& field) {
+        return std::atomic_ref<T>(const_cast<T&>(field)).load(std::memory_order_acquire);
+    }
+}
+
+uint32_t shard_of(std::string_view pair, uint32_t shards) {
+    uint32_t hash = 2166136261u;
+    for (char c : pair) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return shards ? hash % shards : 0;
+}
+
+// ---- Ring ----
+
+bool ShardRing::try_push(const ShardMessage& message) {
+    uint64_t t = std::atomic_ref<uint64_t>(tail).load(std::memory_order_relaxed);
+    if (t - std::atomic_ref<uint64_t>(head).load(std::memory_order_acquire) >= shard_layout::RING_CAPACITY) {
+        return false;
+    }
+    messages[t & (shard_layout::RING_CAPACITY - 1)] = message;
+    std::atomic_ref<uint64_t>(tail).store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShardRing::try_pop(ShardMessage& out) {
+    uint64_t h = std::atomic_ref<uint64_t>(head).load(std::memory_order_relaxed);
+    if (h == std::atomic_ref<uint64_t>(tail).load(std::memory_order_acquire)) return false;
+    out = messages[h & (shard_layout::RING_CAPACITY - 1)];
+    std::atomic_ref<uint64_t>(head).store(h + 1, std::memory_order_release);
+    return true;
+}
+
+// ---- Coordinator ----
+
+ShardCoordinator::ShardCoordinator(std::string segment, uint32_t shards, Notional starting_equity, RiskLimits limits)
+    : name(std::move(segment)), shard_count(shards), account(starting_equity, limits) {
+    if (shards == 0 || shards > shard_layout::MAX_SHARDS) {
+        throw std::invalid_argument("shard count must be 1.." + std::to_string(shard_layout::MAX_SHARDS));
+    }
+    bytes = segment_bytes(shards);
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno));
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("ftruncate " + name + ": " + std::strerror(errno));
+    }
+    memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        memory = nullptr;
+        throw std::runtime_error("mmap " + name + ": " + std::strerror(errno));
+    }
+
+    // A segment left behind by a crashed coordinator is simply reset
+    for (uint32_t k = 0; k < shards; k++) new (&lane(k)) ShardLane{};
+    header = new (memory) ShardHeader{};
+    header->shards = shards;
+    header->account.coordinator_pid = static_cast<uint32_t>(getpid());
+    specs.reserve(256);
+    reservations.reserve(64);
+    publish();
+}
+
+ShardCoordinator::~ShardCoordinator() {
+    if (memory) munmap(memory, bytes);
+    shm_unlink(name.c_str());
+}
+
+void ShardCoordinator::set_stats_publisher(StatsPublisher* publisher) {
+    stats = publisher;
+    merged.set_stats_publisher(publisher);
+}
+
+ShardLane& ShardCoordinator::lane(uint32_t shard) {
+    return *reinterpret_cast<ShardLane*>(static_cast<char*>(memory) + lanes_offset() + shard * sizeof(ShardLane));
+}
+
+size_t ShardCoordinator::poll() {
+    size_t handled = 0;
+    ShardMessage message;
+    for (uint32_t k = 0; k < shard_count; k++) {
+        ShardLane& l = lane(k);
+        while (l.to_coordinator.try_pop(message)) {
+            handle(l, message);
+            handled++;
+        }
+    }
+    if (handled) publish();
+    return handled;
+}
+
+void ShardCoordinator::publish() {
+    ShardAccount& a = header->account;
+    store(a.equity, account.equity().raw);
+    store(a.daily_pnl, account.daily_pnl().raw);
+    store(a.drawdown, account.intraday_drawdown().raw);
+    store(a.cooldown_until_us, system_us(account.cooldown_until()));
+    store(a.open_positions, static_cast<uint32_t>(account.open_positions()));
+    store(a.gate, static_cast<uint32_t>(account.entry_gate()));
+    store(a.halted, static_cast<uint32_t>(account.halted()));
+    store(a.heartbeat_us, steady_us());
+}
+
+const InstrumentSpec& ShardCoordinator::spec_for(const ShardMessage& message) {
+    auto& spec = specs[message.pair];
+    if (!spec) {
+        spec = std::make_unique<InstrumentSpec>();
+        spec->pair = message.pair;
+        spec->base = message.base;
+        spec->pair_decimals = message.pair_decimals;
+        spec->lot_decimals = message.lot_decimals;
+    }
+    return *spec;
+}
+
+// Undo an approval's booking at the price it was booked at (zero P&L)
+void ShardCoordinator::release(PortfolioEngine::PairSlot slot, const Symbol& pair) {
+    auto it = reservations.find(pair);
+    if (it == reservations.end()) return;
+    const Reservation& r = it->second;
+    account.on_fill(slot, r.side == Side::Buy ? Side::Sell : Side::Buy, r.price, r.qty, r.leverage);
+    reservations.erase(it);
+}
+
+void ShardCoordinator::handle(ShardLane& l, const ShardMessage& message) {
+    switch (message.kind) {
+        case ShardMessageKind::Entry: {
+            const InstrumentSpec& spec = spec_for(message);
+            PortfolioEngine::PairSlot slot = account.slot_for(spec);
+            release(slot, spec.pair);  // A stale one would double-count
+
+            ShardMessage reply;
+            reply.kind = ShardMessageKind::Verdict;
+            reply.id = message.id;
+            reply.pair = message.pair;
+            reply.verdict = account.check(slot, message.side, message.price, message.qty, message.leverage);
+            if (reply.verdict == RiskVerdict::Allowed) {
+                account.on_fill(slot, message.side, message.price, message.qty, message.leverage);
+                reservations[spec.pair] = {message.side, message.price, message.qty, message.leverage};
+                approved++;
+            } else {
+                rejected++;
+            }
+            // The worker waits on each Entry, so its reply ring can't fill up
+            l.to_worker.try_push(reply);
+            break;
+        }
+        case ShardMessageKind::Release:
+            release(account.slot_for(spec_for(message)), message.pair);
+            break;
+        case ShardMessageKind::Fill: {
+            const InstrumentSpec& spec = spec_for(message);
+            PortfolioEngine::PairSlot slot = account.slot_for(spec);
+            if (message.settles_reservation) {
+                release(slot, spec.pair);
+                if (stats) stats->on_position_open(spec, message.price, message.qty, message.leverage);
+            }
+            account.on_fill(slot, message.side, message.price, message.qty, message.leverage);
+            break;
+        }
+        case ShardMessageKind::Mark:
+            if (auto it = specs.find(message.pair); it != specs.end()) {
+                account.on_mark(account.slot_for(*it->second), message.price);
+                if (stats) stats->on_mark(message.pair, message.price, message.qty, message.amount);
+            }
+            break;
+        case ShardMessageKind::Fee:
+            account.charge_fee(message.amount);
+            break;
+        case ShardMessageKind::TradeClosed:
+            account.on_trade_closed(message.amount);
+            if (stats) stats->on_position_closed(message.pair);
+            break;
+        case ShardMessageKind::Trade:
+            merged.record_trade(message.trade);
+            merged_trades++;
+            break;
+        case ShardMessageKind::Verdict:
+            break;  // Only ever sent to workers
+    }
+}
+
+// ---- Worker link ----
+
+ShardLink::ShardLink(std::string segment, uint32_t shard, std::chrono::milliseconds timeout)
+    : name(std::move(segment)), index(shard), timeout(timeout) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno) + " (is the coordinator running?)");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShardHeader)) {
+        ::close(fd);
+        throw std::runtime_error(name + " is not a shard segment");
+    }
+    bytes = static_cast<size_t>(st.st_size);
+    memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        memory = nullptr;
+        throw std::runtime_error("mmap " + name + ": " + std::strerror(errno));
+    }
+
+    header = static_cast<ShardHeader*>(memory);
+    std::string error;
+    if (header->magic != shard_layout::MAGIC || header->version != shard_layout::VERSION ||
+        header->lane_size != sizeof(ShardLane) || bytes < segment_bytes(header->shards)) {
+        error = name + ": incompatible shard segment layout";
+    } else if (index >= header->shards) {
+        error = "worker " + std::to_string(index) + " out of range for " + std::to_string(header->shards) + " shards";
+    }
+    if (!error.empty()) {
+        munmap(memory, bytes);
+        memory = nullptr;
+        throw std::runtime_error(error);
+    }
+    lane = reinterpret_cast<ShardLane*>(static_cast<char*>(memory) + lanes_offset() + index * sizeof(ShardLane));
+    store(lane->worker_pid, static_cast<uint32_t>(getpid()));
+}
+
+ShardLink::~ShardLink() {
+    if (memory) munmap(memory, bytes);
+}
+
+RiskVerdict ShardLink::entry_gate() const {
+    if (steady_us() - load(header->account.heartbeat_us) >
+        std::chrono::duration_cast<std::chrono::microseconds>(HEARTBEAT_TIMEOUT).count()) {
+        return RiskVerdict::Unreachable;
+    }
+    return static_cast<RiskVerdict>(load(header->account.gate));
+}
+
+bool ShardLink::halted() const { return load(header->account.halted) != 0; }
+Notional ShardLink::account_equity() const { return {load(header->account.equity)}; }
+Notional ShardLink::account_daily_pnl() const { return {load(header->account.daily_pnl)}; }
+Notional ShardLink::account_drawdown() const { return {load(header->account.drawdown)}; }
+
+ShardMessage ShardLink::for_pair(ShardMessageKind kind, const InstrumentSpec& spec) {
+    ShardMessage message;
+    message.kind = kind;
+    message.pair = spec.pair;
+    message.base = spec.base;
+    message.pair_decimals = spec.pair_decimals;
+    message.lot_decimals = spec.lot_decimals;
+    return message;
+}
+
+// Spin briefly, then back off to short sleeps until the deadline
+bool ShardLink::send(const ShardMessage& message, bool may_drop) {
+    if (lane->to_coordinator.try_push(message)) return true;
+    if (may_drop) return false;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (int spins = 0; !lane->to_coordinator.try_push(message); spins++) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            std::cerr << "  ⚠️  Shard " << index << ": coordinator queue full, message dropped" << std::endl;
+            return false;
+        }
+        if (spins < 1000) realtime::cpu_relax();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+}
+
+RiskVerdict ShardLink::check(const InstrumentSpec& spec, Side side, Price price, Qty volume, double leverage) {
+    if (RiskVerdict gate = entry_gate(); gate == RiskVerdict::Unreachable) return gate;
+
+    ShardMessage request = for_pair(ShardMessageKind::Entry, spec);
+    request.id = ++next_id;
+    request.side = side;
+    request.price = price;
+    request.qty = volume;
+    request.leverage = leverage;
+    if (!send(request)) return RiskVerdict::Unreachable;
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    ShardMessage reply;
+    for (int spins = 0; std::chrono::steady_clock::now() < deadline; spins++) {
+        while (lane->to_worker.try_pop(reply)) {
+            if (reply.kind == ShardMessageKind::Verdict && reply.id == request.id) return reply.verdict;
+            // Otherwise a verdict for a request that already timed out
+        }
+        if (spins < 1000) realtime::cpu_relax();
+        else std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+
+    // Late approval would leave a reservation behind; Release follows the
+    // Entry through the same ring, so it always undoes it
+    release(spec);
+    return RiskVerdict::Unreachable;
+}
+
+void ShardLink::release(const InstrumentSpec& spec) {
+    send(for_pair(ShardMessageKind::Release, spec));
+}
+
+void ShardLink::on_fill(const InstrumentSpec& spec, Side side, Price price, Qty volume, double leverage,
+                        bool settles_reservation) {
+    ShardMessage message = for_pair(ShardMessageKind::Fill, spec);
+    message.side = side;
+    message.price = price;
+    message.qty = volume;
+    message.leverage = leverage;
+    message.settles_reservation = settles_reservation;
+    send(message);
+}
+
+void ShardLink::on_mark(const Symbol& pair, Price mark, Qty size, Notional unrealized_pnl) {
+    // Marks are absolute - the next one replaces a dropped one
+    ShardMessage message;
+    message.kind = ShardMessageKind::Mark;
+    message.pair = pair;
+    message.price = mark;
+    message.qty = size;
+    message.amount = unrealized_pnl;
+    send(message, true);
+}
+
+void ShardLink::charge_fee(Notional fee) {
+    ShardMessage message;
+    message.kind = ShardMessageKind::Fee;
+    message.amount = fee;
+    send(message);
+}
+
+void ShardLink::on_trade_closed(const Symbol& pair, Notional net_pnl) {
+    ShardMessage message;
+    message.kind = ShardMessageKind::TradeClosed;
+    message.pair = pair;
+    message.amount = net_pnl;
+    send(message);
+}
+
+void ShardLink::record_trade(const TradeRecord& trade) {
+    ShardMessage message;
+    message.kind = ShardMessageKind::Trade;
+    message.pair = trade.pair;
+    message.trade = trade;
+    send(message);
+}
+
+RequestScheduler::Transport ShardLink::serialize_private(RequestScheduler::Transport inner) {
+    return [this, inner = std::move(inner)](const std::string& endpoint, const json& params, bool is_private) {
+        if (!is_private) return inner(endpoint, params, is_private);
+
+        std::atomic_ref<uint32_t> owner(header->private_call_owner);
+        auto self = static_cast<uint32_t>(getpid());
+        for (int spins = 0;; spins++) {
+            uint32_t holder = 0;
+            if (owner.compare_exchange_weak(holder, self, std::memory_order_acquire)) break;
+            // Holder died mid-call (no process, not just no permission)
+            if (holder != 0 && kill(static_cast<pid_t>(holder), 0) != 0 && errno == ESRCH &&
+                owner.compare_exchange_strong(holder, self, std::memory_order_acquire)) {
+                break;
+            }
+            if (spins < 100) realtime::cpu_relax();
+            else std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        struct Unlock {
+            std::atomic_ref<uint32_t>& owner;
+            ~Unlock() { owner.store(0, std::memory_order_release); }
+        } unlock{owner};
+        return inner(endpoint, params, is_private);
+    };
+}
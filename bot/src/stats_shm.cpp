@@ -0,0 +1,300 @@
+#include "stats_shm.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// server.js decodes the segment by offset - keep these in sync with it
+static_assert(std::is_trivially_copyable_v<StatsSegment>);
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+static_assert(offsetof(StatsSegment, sequence) == 8);
+static_assert(offsetof(StatsSegment, trades) == 40);
+static_assert(offsetof(StatsSegment, regime) == 80);
+static_assert(offsetof(StatsSegment, positions) == 104);
+static_assert(offsetof(StatsSegment, patterns) == 1384);
+static_assert(offsetof(StatsSegment, latency) == 6504);
+static_assert(sizeof(ShmPosition) == 80);
+static_assert(sizeof(ShmPattern) == 80);
+static_assert(sizeof(ShmLatency) == 296);
+static_assert(sizeof(StatsSegment) == 7392);
+
+namespace {
+    int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    template <size_t N>
+    void copy_text(char (&dest)[N], std::string_view text) {
+        size_t n = std::min(text.size(), N - 1);
+        std::memcpy(dest, text.data(), n);
+        std::memset(dest + n, 0, N - n);
+    }
+
+    template <size_t N>
+    std::string_view text_of(const char (&src)[N]) {
+        return {src, strnlen(src, N)};
+    }
+
+    // Upper bound of the bucket holding the q-quantile, in microseconds
+    double bucket_quantile_us(const ShmLatency& l, double q) {
+        if (l.count == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(std::ceil(q * l.count));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < stats_layout::LATENCY_BUCKETS; i++) {
+            seen += l.buckets[i];
+            if (seen >= target) return std::min<double>(std::ldexp(1.0, static_cast<int>(i) + 1), l.max_ns) / 1000.0;
+        }
+        return l.max_ns / 1000.0;
+    }
+}
+
+const char* to_string(LatencyKind kind) {
+    switch (kind) {
+        case LatencyKind::Order: return "order";
+        case LatencyKind::MarketData: return "market_data";
+        case LatencyKind::Decision: return "decision";
+        default: return "unknown";
+    }
+}
+
+// ---- Writer ----
+
+StatsPublisher::Write::Write(StatsSegment* s) : segment(s) {
+    std::atomic_ref<uint64_t> sequence(segment->sequence);
+    start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+StatsPublisher::Write::~Write() {
+    segment->updated_us = now_us();
+    std::atomic_ref<uint64_t>(segment->sequence).store(start + 2, std::memory_order_release);
+}
+
+StatsPublisher::StatsPublisher(std::string name) : name(std::move(name)) {
+    int fd = shm_open(this->name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) throw std::runtime_error("shm_open " + this->name + ": " + std::strerror(errno));
+    if (ftruncate(fd, sizeof(StatsSegment)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("ftruncate " + this->name + ": " + std::strerror(errno));
+    }
+    void* mem = mmap(nullptr, sizeof(StatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) throw std::runtime_error("mmap " + this->name + ": " + std::strerror(errno));
+
+    segment = new (mem) StatsSegment{};
+    segment->pid = static_cast<uint32_t>(getpid());
+    segment->started_us = now_us();
+    segment->updated_us = segment->started_us;
+    copy_text(segment->regime, "unknown");
+    for (size_t k = 0; k < static_cast<size_t>(LatencyKind::Count); k++) {
+        copy_text(segment->latency[k].name, to_string(static_cast<LatencyKind>(k)));
+    }
+    pattern_slots.reserve(stats_layout::MAX_PATTERNS);
+    position_slots.reserve(stats_layout::MAX_POSITIONS);
+}
+
+StatsPublisher::~StatsPublisher() {
+    if (segment) munmap(segment, sizeof(StatsSegment));
+    shm_unlink(name.c_str());
+}
+
+void StatsPublisher::on_trade(std::string_view pattern_key, Notional net_pnl, double roi, std::string_view regime) {
+    std::lock_guard<std::mutex> lock(writer);
+    uint32_t slot = UINT32_MAX;
+    auto it = pattern_slots.find(std::string(pattern_key));
+    if (it != pattern_slots.end()) {
+        slot = it->second;
+    } else if (pattern_slots.size() < stats_layout::MAX_PATTERNS) {
+        slot = static_cast<uint32_t>(pattern_slots.size());
+        pattern_slots.emplace(pattern_key, slot);
+    }
+
+    Write write(segment);
+    segment->trades++;
+    if (net_pnl.raw > 0) segment->wins++;
+    segment->session_pnl += net_pnl.raw;
+    segment->peak_pnl = std::max(segment->peak_pnl, segment->session_pnl);
+    segment->max_drawdown = std::max(segment->max_drawdown, segment->peak_pnl - segment->session_pnl);
+    copy_text(segment->regime, regime);
+
+    if (slot != UINT32_MAX) {
+        ShmPattern& p = segment->patterns[slot];
+        if (p.trades == 0) {
+            copy_text(p.key, pattern_key);
+            segment->pattern_count = static_cast<uint32_t>(pattern_slots.size());
+        }
+        p.trades++;
+        if (net_pnl.raw > 0) p.wins++;
+        p.pnl += net_pnl.raw;
+        p.roi_sum += roi;
+        p.roi_sq_sum += roi * roi;
+        p.last_trade_us = now_us();
+    }
+}
+
+void StatsPublisher::on_position_open(const InstrumentSpec& spec, Price entry, Qty size, double leverage) {
+    std::lock_guard<std::mutex> lock(writer);
+    uint32_t slot = UINT32_MAX;
+    if (auto it = position_slots.find(spec.pair); it != position_slots.end()) {
+        slot = it->second;
+    } else {
+        for (uint32_t i = 0; i < stats_layout::MAX_POSITIONS; i++) {
+            if (segment->positions[i].pair[0] == '\0') { slot = i; break; }
+        }
+        if (slot == UINT32_MAX) return;  // Table full - position not exported
+        position_slots.emplace(spec.pair, slot);
+    }
+
+    Write write(segment);
+    ShmPosition& p = segment->positions[slot];
+    copy_text(p.pair, spec.pair.view());
+    p.size_lots = size.lots;
+    p.entry_ticks = entry.ticks;
+    p.mark_ticks = entry.ticks;
+    p.unrealized_pnl = 0;
+    p.leverage = leverage;
+    p.pair_decimals = spec.pair_decimals;
+    p.lot_decimals = spec.lot_decimals;
+    p.opened_us = now_us();
+    segment->open_positions = static_cast<uint32_t>(position_slots.size());
+}
+
+void StatsPublisher::on_mark(const Symbol& pair, Price mark, Qty size, Notional unrealized_pnl) {
+    std::lock_guard<std::mutex> lock(writer);
+    auto it = position_slots.find(pair);
+    if (it == position_slots.end()) return;
+
+    Write write(segment);
+    ShmPosition& p = segment->positions[it->second];
+    p.mark_ticks = mark.ticks;
+    p.size_lots = size.lots;
+    p.unrealized_pnl = unrealized_pnl.raw;
+}
+
+void StatsPublisher::on_position_closed(const Symbol& pair) {
+    std::lock_guard<std::mutex> lock(writer);
+    auto it = position_slots.find(pair);
+    if (it == position_slots.end()) return;
+    uint32_t slot = it->second;
+    position_slots.erase(it);
+
+    Write write(segment);
+    segment->positions[slot] = ShmPosition{};
+    segment->open_positions = static_cast<uint32_t>(position_slots.size());
+}
+
+void StatsPublisher::record_latency(LatencyKind kind, std::chrono::nanoseconds elapsed) {
+    std::lock_guard<std::mutex> lock(writer);
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+    size_t bucket = ns ? std::min<size_t>(std::bit_width(ns) - 1, stats_layout::LATENCY_BUCKETS - 1) : 0;
+
+    Write write(segment);
+    ShmLatency& l = segment->latency[static_cast<size_t>(kind)];
+    l.count++;
+    l.sum_ns += ns;
+    l.max_ns = std::max(l.max_ns, ns);
+    l.buckets[bucket]++;
+}
+
+// ---- Reader ----
+
+StatsReader::StatsReader(std::string name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno) + " (is the bot running?)");
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(StatsSegment)) {
+        ::close(fd);
+        throw std::runtime_error("Stats segment " + name + " is too small");
+    }
+    void* mem = mmap(nullptr, sizeof(StatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) throw std::runtime_error("mmap " + name + ": " + std::strerror(errno));
+
+    segment = static_cast<const StatsSegment*>(mem);
+    if (segment->magic != stats_layout::MAGIC || segment->version != stats_layout::VERSION ||
+        segment->layout_size != sizeof(StatsSegment)) {
+        munmap(const_cast<StatsSegment*>(segment), sizeof(StatsSegment));
+        segment = nullptr;
+        throw std::runtime_error("Stats segment " + name + " has an unknown layout");
+    }
+}
+
+StatsReader::~StatsReader() {
+    if (segment) munmap(const_cast<StatsSegment*>(segment), sizeof(StatsSegment));
+}
+
+bool StatsReader::read(StatsSegment& out, int max_attempts) const {
+    std::atomic_ref<uint64_t> sequence(const_cast<StatsSegment*>(segment)->sequence);
+    for (int attempt = 0; attempt < max_attempts; attempt++) {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;  // Write in progress
+        std::memcpy(static_cast<void*>(&out), segment, sizeof(StatsSegment));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+json StatsReader::to_json(const StatsSegment& s) {
+    json out;
+    out["pid"] = s.pid;
+    out["started_us"] = s.started_us;
+    out["updated_us"] = s.updated_us;
+    out["sequence"] = s.sequence;
+    out["trades"] = s.trades;
+    out["wins"] = s.wins;
+    out["win_rate"] = s.trades ? static_cast<double>(s.wins) / s.trades : 0.0;
+    out["session_pnl"] = Notional{s.session_pnl}.to_double();
+    out["max_drawdown"] = Notional{s.max_drawdown}.to_double();
+    out["regime"] = text_of(s.regime);
+
+    out["positions"] = json::array();
+    for (const auto& p : s.positions) {
+        if (p.pair[0] == '\0') continue;
+        out["positions"].push_back({
+            {"pair", text_of(p.pair)},
+            {"size", fixed_point::format<31>(p.size_lots, p.lot_decimals).str()},
+            {"entry", fixed_point::format<31>(p.entry_ticks, p.pair_decimals).str()},
+            {"mark", fixed_point::format<31>(p.mark_ticks, p.pair_decimals).str()},
+            {"unrealized_pnl", Notional{p.unrealized_pnl}.to_double()},
+            {"leverage", p.leverage},
+            {"opened_us", p.opened_us}
+        });
+    }
+
+    out["patterns"] = json::array();
+    for (uint32_t i = 0; i < std::min<uint32_t>(s.pattern_count, stats_layout::MAX_PATTERNS); i++) {
+        const ShmPattern& p = s.patterns[i];
+        double mean = p.trades ? p.roi_sum / p.trades : 0;
+        double variance = p.trades ? std::max(0.0, p.roi_sq_sum / p.trades - mean * mean) : 0;
+        double std_dev = std::sqrt(variance);
+        out["patterns"].push_back({
+            {"key", text_of(p.key)},
+            {"trades", p.trades},
+            {"win_rate", p.trades ? static_cast<double>(p.wins) / p.trades : 0.0},
+            {"pnl", Notional{p.pnl}.to_double()},
+            {"avg_roi", mean},
+            {"sharpe", p.trades >= 2 && std_dev > 0 ? mean / std_dev : 0.0}
+        });
+    }
+
+    for (const auto& l : s.latency) {
+        out["latency"][std::string(text_of(l.name))] = {
+            {"count", l.count},
+            {"mean_us", l.count ? l.sum_ns / 1000.0 / l.count : 0.0},
+            {"p50_us", bucket_quantile_us(l, 0.50)},
+            {"p99_us", bucket_quantile_us(l, 0.99)},
+            {"max_us", l.max_ns / 1000.0}
+        };
+    }
+    return out;
+}
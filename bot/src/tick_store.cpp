@@ -0,0 +1,420 @@
+#include "tick_store.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace tick_format;
+
+namespace {
+    inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    inline int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+    inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    inline uint64_t get_varint(const uint8_t*& p) {
+        // One-byte fast path: most deltas are tiny
+        uint64_t v = *p++;
+        if (v < 0x80) return v;
+        v &= 0x7F;
+        for (int shift = 7;; shift += 7) {
+            uint64_t byte = *p++;
+            v |= (byte & 0x7F) << shift;
+            if (byte < 0x80) return v;
+        }
+    }
+
+    std::string sanitize(const Symbol& pair) {
+        std::string name = pair.str();
+        std::replace(name.begin(), name.end(), '/', '_');
+        return name;
+    }
+}
+
+int32_t tick_format::utc_day(int64_t timestamp_us) {
+    using namespace std::chrono;
+    sys_days day = floor<days>(sys_time<microseconds>(microseconds(timestamp_us)));
+    year_month_day ymd(day);
+    return static_cast<int>(ymd.year()) * 10000 +
+           static_cast<int>(static_cast<unsigned>(ymd.month())) * 100 +
+           static_cast<int>(static_cast<unsigned>(ymd.day()));
+}
+
+// ---------------------------------------------------------------------------
+// SegmentWriter
+// ---------------------------------------------------------------------------
+
+SegmentWriter::SegmentWriter(const std::string& path, const InstrumentSpec& spec, int32_t day, size_t block_rows,
+                             int64_t block_span_us)
+    : path(path), segment_day(day), block_rows(block_rows), block_span_us(block_span_us) {
+    FileHeader header;
+    std::memcpy(header.pair, spec.pair.data(), std::min(spec.pair.size(), sizeof(header.pair) - 1));
+    header.day = day;
+    header.pair_decimals = spec.pair_decimals;
+    header.lot_decimals = spec.lot_decimals;
+    open_file();
+    write(&header, sizeof(header));
+    close_file();
+
+    pending.reserve(block_rows);
+}
+
+SegmentWriter::~SegmentWriter() {
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️  " << e.what() << std::endl;
+    }
+}
+
+void SegmentWriter::open_file() {
+    file = std::fopen(path.c_str(), offset == 0 ? "wb" : "ab");
+    if (!file) {
+        failed = true;
+        throw std::runtime_error("Cannot open tick segment " + path + ": " + std::strerror(errno));
+    }
+}
+
+void SegmentWriter::close_file() {
+    std::FILE* f = file;
+    file = nullptr;
+    if (f && std::fclose(f) != 0) {
+        failed = true;
+        throw std::runtime_error("Tick segment write failed: " + path + ": " + std::strerror(errno));
+    }
+}
+
+void SegmentWriter::write(const void* data, size_t len) {
+    if (std::fwrite(data, 1, len, file) != len) {
+        int error = errno;
+        std::fclose(file);
+        file = nullptr;
+        failed = true;
+        throw std::runtime_error("Tick segment write failed: " + path + ": " + std::strerror(error));
+    }
+    offset += len;
+}
+
+void SegmentWriter::append(const Tick& tick) {
+    Tick row = tick;
+    // Range queries rely on non-decreasing time within a segment
+    if (!pending.empty() && row.timestamp_us < pending.back().timestamp_us) {
+        row.timestamp_us = pending.back().timestamp_us;
+    } else if (pending.empty() && !index.empty() && row.timestamp_us < index.back().last_ts) {
+        row.timestamp_us = index.back().last_ts;
+    }
+
+    pending.push_back(row);
+    if (pending.size() >= block_rows || row.timestamp_us - pending.front().timestamp_us >= block_span_us) flush();
+}
+
+void SegmentWriter::flush() {
+    if (finished || failed || pending.empty()) return;
+
+    ts_col.clear();
+    kind_col.clear();
+    price_col.clear();
+    qty_col.clear();
+
+    int64_t prev_ts = pending.front().timestamp_us;
+    int64_t prev_price = 0;
+    for (const Tick& t : pending) {
+        put_varint(ts_col, zigzag(t.timestamp_us - prev_ts));
+        kind_col.push_back(static_cast<uint8_t>(t.kind));
+        put_varint(price_col, zigzag(t.price.ticks - prev_price));
+        put_varint(qty_col, zigzag(t.qty.lots));
+        prev_ts = t.timestamp_us;
+        prev_price = t.price.ticks;
+    }
+
+    BlockHeader block;
+    block.rows = static_cast<uint32_t>(pending.size());
+    block.first_ts = pending.front().timestamp_us;
+    block.last_ts = pending.back().timestamp_us;
+    block.ts_bytes = static_cast<uint32_t>(ts_col.size());
+    block.kind_bytes = static_cast<uint32_t>(kind_col.size());
+    block.price_bytes = static_cast<uint32_t>(price_col.size());
+    block.qty_bytes = static_cast<uint32_t>(qty_col.size());
+
+    IndexEntry entry;
+    entry.first_ts = block.first_ts;
+    entry.last_ts = block.last_ts;
+    entry.offset = offset;
+    entry.rows = block.rows;
+
+    open_file();
+    write(&block, sizeof(block));
+    write(ts_col.data(), ts_col.size());
+    write(kind_col.data(), kind_col.size());
+    write(price_col.data(), price_col.size());
+    write(qty_col.data(), qty_col.size());
+    close_file();
+
+    index.push_back(entry);
+    total_rows += pending.size();
+    pending.clear();
+}
+
+void SegmentWriter::close() {
+    if (finished || failed) return;
+    flush();
+    finished = true;
+
+    Footer footer;
+    footer.index_offset = offset;
+    footer.block_count = static_cast<uint32_t>(index.size());
+    open_file();
+    write(index.data(), index.size() * sizeof(IndexEntry));
+    write(&footer, sizeof(footer));
+    close_file();
+}
+
+// ---------------------------------------------------------------------------
+// TickRecorder
+// ---------------------------------------------------------------------------
+
+TickRecorder::TickRecorder(std::string directory, size_t block_rows, std::chrono::seconds block_span)
+    : directory(std::move(directory)), block_rows(block_rows),
+      block_span_us(std::chrono::duration_cast<std::chrono::microseconds>(block_span).count()) {
+    fs::create_directories(this->directory);
+}
+
+TickRecorder::~TickRecorder() {
+    close();
+}
+
+std::string TickRecorder::pair_directory(const std::string& directory, const Symbol& pair) {
+    return (fs::path(directory) / sanitize(pair)).string();
+}
+
+SegmentWriter& TickRecorder::writer_for(const InstrumentSpec& spec, int32_t day) {
+    auto& writer = writers[spec.pair];
+    if (writer && writer->day() == day) return *writer;
+
+    // New pair or UTC day rollover; never overwrite an earlier segment
+    writer.reset();
+    fs::path dir = pair_directory(directory, spec.pair);
+    fs::create_directories(dir);
+    fs::path path = dir / (std::to_string(day) + ".seg");
+    for (int n = 1; fs::exists(path); n++) {
+        path = dir / (std::to_string(day) + "-" + std::to_string(n) + ".seg");
+    }
+    writer = std::make_unique<SegmentWriter>(path.string(), spec, day, block_rows, block_span_us);
+    return *writer;
+}
+
+void TickRecorder::report(const Symbol& pair, const std::exception& error) {
+    // The first failure and then every 1000th, so a full disk doesn't flood the log
+    if (errors++ % 1000 == 0) {
+        std::cerr << "⚠️  Tick history for " << pair << ": " << error.what() << " (" << errors
+                  << " write error" << (errors == 1 ? "" : "s") << " so far)" << std::endl;
+    }
+    writers.erase(pair);  // The next row starts a new segment
+}
+
+void TickRecorder::record(const InstrumentSpec& spec, const Tick& tick) {
+    try {
+        writer_for(spec, utc_day(tick.timestamp_us)).append(tick);
+    } catch (const std::runtime_error& e) {  // Includes filesystem_error
+        report(spec.pair, e);
+    }
+}
+
+void TickRecorder::record_ticker(const InstrumentSpec& spec, const json& ticker, int64_t timestamp_us) {
+    // Kraken ticker arrays: [price, whole lot volume, lot volume] / last: [price, lot volume]
+    auto row = [&](const char* field, TickKind kind, size_t qty_index) {
+        if (!ticker.contains(field)) return;
+        const json& values = ticker[field];
+        Tick tick;
+        tick.timestamp_us = timestamp_us;
+        tick.kind = kind;
+        tick.price = spec.parse_price(values[0].get<std::string>());
+        if (values.size() > qty_index) tick.qty = spec.parse_qty(values[qty_index].get<std::string>());
+        record(spec, tick);
+    };
+    row("b", TickKind::Bid, 2);
+    row("a", TickKind::Ask, 2);
+    row("c", TickKind::Last, 1);
+}
+
+void TickRecorder::record_book(const InstrumentSpec& spec, Side side, Price price, Qty qty, int64_t timestamp_us) {
+    record(spec, Tick{timestamp_us, side == Side::Buy ? TickKind::BookBid : TickKind::BookAsk, price, qty});
+}
+
+void TickRecorder::record_depth(const InstrumentSpec& spec, const json& depth, int64_t timestamp_us) {
+    for (auto [field, side] : {std::pair{"asks", Side::Sell}, std::pair{"bids", Side::Buy}}) {
+        if (!depth.contains(field)) continue;
+        for (const auto& level : depth[field]) {
+            record_book(spec, side, spec.parse_price(level[0].get<std::string>()),
+                        spec.parse_qty(level[1].get<std::string>()), timestamp_us);
+        }
+    }
+}
+
+void TickRecorder::flush() {
+    flush_due(INT64_MAX);
+}
+
+void TickRecorder::flush_due(int64_t now_us) {
+    std::vector<Symbol> failed;
+    std::vector<std::string> messages;
+    for (auto& [pair, writer] : writers) {
+        if (!writer || !writer->due(now_us)) continue;
+        try {
+            writer->flush();
+        } catch (const std::runtime_error& e) {
+            failed.push_back(pair);
+            messages.push_back(e.what());
+        }
+    }
+    for (size_t i = 0; i < failed.size(); i++) report(failed[i], std::runtime_error(messages[i]));
+}
+
+void TickRecorder::close() {
+    writers.clear();  // Each writer closes with index + footer
+}
+
+// ---------------------------------------------------------------------------
+// SegmentReader
+// ---------------------------------------------------------------------------
+
+SegmentReader::SegmentReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open tick segment: " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Truncated tick segment: " + path);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot mmap tick segment: " + path);
+    data = static_cast<const uint8_t*>(mapped);
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    file_header = reinterpret_cast<const FileHeader*>(data);
+    if (file_header->magic != FILE_MAGIC || file_header->version != VERSION) {
+        ::munmap(mapped, size);
+        throw std::runtime_error("Not a tick segment: " + path);
+    }
+
+    Footer footer;
+    bool has_footer = false;
+    if (size >= sizeof(FileHeader) + sizeof(Footer)) {
+        std::memcpy(&footer, data + size - sizeof(Footer), sizeof(Footer));
+        has_footer = footer.magic == FOOTER_MAGIC &&
+                     footer.index_offset + footer.block_count * sizeof(IndexEntry) + sizeof(Footer) == size;
+    }
+
+    if (has_footer) {
+        index.resize(footer.block_count);
+        std::memcpy(index.data(), data + footer.index_offset, footer.block_count * sizeof(IndexEntry));
+    } else {
+        rebuild_index();
+    }
+}
+
+SegmentReader::~SegmentReader() {
+    if (data) ::munmap(const_cast<uint8_t*>(data), size);
+}
+
+void SegmentReader::rebuild_index() {
+    // Crashed writer: walk block headers until the data runs out
+    size_t pos = sizeof(FileHeader);
+    while (pos + sizeof(BlockHeader) <= size) {
+        BlockHeader block;
+        std::memcpy(&block, data + pos, sizeof(block));
+        if (block.magic != BLOCK_MAGIC) break;
+
+        size_t end = pos + sizeof(block) + block.ts_bytes + block.kind_bytes + block.price_bytes + block.qty_bytes;
+        if (end > size) break;
+
+        index.push_back(IndexEntry{block.first_ts, block.last_ts, pos, block.rows, 0});
+        pos = end;
+    }
+}
+
+uint64_t SegmentReader::row_count() const {
+    uint64_t rows = 0;
+    for (const auto& entry : index) rows += entry.rows;
+    return rows;
+}
+
+void SegmentReader::decode_block(size_t b, TickBatch& out) const {
+    BlockHeader block;
+    std::memcpy(&block, data + index[b].offset, sizeof(block));
+    const uint8_t* ts_p = data + index[b].offset + sizeof(block);
+    const uint8_t* kind_p = ts_p + block.ts_bytes;
+    const uint8_t* price_p = kind_p + block.kind_bytes;
+    const uint8_t* qty_p = price_p + block.price_bytes;
+
+    size_t n = block.rows;
+    out.timestamp_us.resize(n);
+    out.kind.assign(kind_p, kind_p + n);
+    out.price.resize(n);
+    out.qty.resize(n);
+
+    int64_t ts = block.first_ts;
+    for (size_t i = 0; i < n; i++) {
+        ts += unzigzag(get_varint(ts_p));
+        out.timestamp_us[i] = ts;
+    }
+    int64_t price = 0;
+    for (size_t i = 0; i < n; i++) {
+        price += unzigzag(get_varint(price_p));
+        out.price[i] = price;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out.qty[i] = unzigzag(get_varint(qty_p));
+    }
+
+    out.begin = 0;
+    out.end = n;
+}
+
+// ---------------------------------------------------------------------------
+// TickHistory
+// ---------------------------------------------------------------------------
+
+std::vector<std::string> TickHistory::segments(const Symbol& pair, int64_t from_us, int64_t to_us) const {
+    std::vector<std::string> paths;
+    fs::path dir = TickRecorder::pair_directory(directory, pair);
+    if (!fs::exists(dir)) return paths;
+
+    int32_t first_day = utc_day(from_us);
+    int32_t last_day = utc_day(to_us);
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.path().extension() != ".seg") continue;
+        // "YYYYMMDD.seg" or "YYYYMMDD-n.seg"
+        int32_t day = std::atoi(entry.path().stem().string().substr(0, 8).c_str());
+        if (day >= first_day && day <= last_day) paths.push_back(entry.path().string());
+    }
+
+    // Day order, then restart sequence order
+    std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) {
+        auto key = [](const std::string& p) {
+            std::string stem = fs::path(p).stem().string();
+            size_t dash = stem.find('-');
+            int seq = dash == std::string::npos ? 0 : std::atoi(stem.c_str() + dash + 1);
+            return std::make_pair(stem.substr(0, 8), seq);
+        };
+        return key(a) < key(b);
+    });
+    return paths;
+}
@@ -0,0 +1,94 @@
+#include <string_view>
+#include "alloc_counter.hpp"
+#include "instrument.hpp"
+#include "order_book.hpp"
+#include "portfolio.hpp"
+#include "test_check.hpp"
+
+/*
+ * The per-decision path must not touch the heap once its state exists.
+ * Built with KRAKEN_COUNT_ALLOCATIONS, so AllocationScope counts every
+ * operator new on this thread.
+ */
+
+namespace {
+    InstrumentRegistry registry() {
+        InstrumentRegistry instruments;
+        instruments.load_asset_pairs(json::parse(R"({
+            "XXBTZUSD": {"altname": "XBTUSD", "wsname": "XBT/USD", "base": "XXBT",
+                         "pair_decimals": 1, "lot_decimals": 8, "ordermin": "0.0001"},
+            "XETHZUSD": {"altname": "ETHUSD", "wsname": "ETH/USD", "base": "XETH",
+                         "pair_decimals": 2, "lot_decimals": 8, "ordermin": "0.002"}
+        })"));
+        return instruments;
+    }
+
+    // Lookup by any of the three names, from a view or a Symbol
+    void pair_lookup_is_allocation_free() {
+        InstrumentRegistry instruments = registry();
+        Symbol wsname("ETH/USD");
+        std::string_view altname = "XBTUSD";
+
+        AllocationScope scope;
+        const InstrumentSpec* xbt = instruments.find(altname);
+        const InstrumentSpec* eth = instruments.find(wsname.view());
+        const InstrumentSpec* missing = instruments.find("DOGEUSD");
+        CHECK(scope.count() == 0);
+        CHECK(xbt && xbt->pair == Symbol("XXBTZUSD"));
+        CHECK(eth && eth->pair == Symbol("XETHZUSD"));
+        CHECK(!missing);
+        PASS("pair_lookup_is_allocation_free");
+    }
+
+    // What execute_trade runs between the quote and the order
+    void sizing_and_risk_check_are_allocation_free() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& spec = instruments.get("XBTUSD");
+        PortfolioEngine portfolio(Notional::from_double(10000));
+        PortfolioEngine::PairSlot slot = portfolio.slot_for(spec);
+        Price quote = spec.price_from_double(50000.0);
+
+        AllocationScope scope;
+        Qty volume = spec.qty_for_notional(Notional::from_double(100), quote);
+        bool sized = spec.meets_minimum(volume);
+        RiskVerdict verdict = portfolio.check(slot, Side::Buy, quote, volume, 2.0);
+        portfolio.on_fill(slot, Side::Buy, quote, volume, 2.0);
+        portfolio.on_mark(slot, spec.price_from_double(50100.0));
+        portfolio.on_fill(slot, Side::Sell, spec.price_from_double(50100.0), volume, 1.0);
+        portfolio.on_trade_closed(Notional::from_double(1));
+        scope.expect_none("sizing + risk check");
+        CHECK(scope.count() == 0);
+        CHECK(sized);
+        CHECK(verdict == RiskVerdict::Allowed);
+        PASS("sizing_and_risk_check_are_allocation_free");
+    }
+
+    // Book queries walk the preallocated levels only
+    void fill_estimate_is_allocation_free() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& spec = instruments.get("XBTUSD");
+        OrderBookSet books(4, 10);
+        OrderBookSet::BookSlot slot = books.slot_for(spec);
+        books.apply_snapshot(slot, json::parse(R"({
+            "asks": [["50000.0", "0.50000000", "1"], ["50010.0", "1.00000000", "1"]],
+            "bids": [["49990.0", "0.75000000", "1"], ["49980.0", "2.00000000", "1"]]
+        })"));
+
+        AllocationScope scope;
+        FillEstimate buy = books.estimate_fill(slot, Side::Buy, Notional::from_double(30000));
+        FillEstimate sell = books.estimate_fill(slot, Side::Sell, spec.parse_qty("1.0"));
+        double imbalance = books.imbalance(slot);
+        CHECK(scope.count() == 0);
+        CHECK(buy.complete && sell.complete);
+        CHECK(imbalance != 0.0);
+        PASS("fill_estimate_is_allocation_free");
+    }
+}
+
+int main() {
+    CHECK(alloc_counter::enabled());
+    pair_lookup_is_allocation_free();
+    sizing_and_risk_check_are_allocation_free();
+    fill_estimate_is_allocation_free();
+    return 0;
+}
@@ -0,0 +1,322 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "async_kraken_api.hpp"
+#include "test_check.hpp"
+
+/*
+ * AsyncKrakenAPI against a local mock exchange: calls are admitted by the
+ * shared RequestScheduler, private calls never overlap (not even with the
+ * scheduler's own private lane) and carry increasing nonces, and tasks
+ * left suspended are destroyed with their loop.
+ */
+
+using namespace std::chrono_literals;
+
+namespace {
+    // Minimal HTTP/1.1 server: one thread per connection, Connection: close
+    class MockExchange {
+    public:
+        std::atomic<int> private_in_call{0};
+        std::atomic<int> private_overlaps{0};
+        std::atomic<int64_t> ask_ticks{1000};  // XBTUSD ask, 0.1 ticks
+        std::chrono::milliseconds public_delay{0};
+        std::chrono::milliseconds private_delay{0};
+
+        MockExchange() {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+            CHECK(listener >= 0);
+            int on = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            CHECK(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+            CHECK(listen(listener, 128) == 0);
+            socklen_t length = sizeof(address);
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+            acceptor = std::thread([this] { accept_loop(); });
+        }
+
+        ~MockExchange() {
+            stopping = true;
+            shutdown(listener, SHUT_RDWR);
+            close(listener);
+            acceptor.join();
+            for (auto& handler : handlers) handler.join();
+        }
+
+        std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+        // Nonces of private calls, in the order they arrived
+        std::vector<uint64_t> nonces() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return received_nonces;
+        }
+
+    private:
+        int listener = -1;
+        uint16_t port = 0;
+        std::atomic<bool> stopping{false};
+        std::thread acceptor;
+        std::vector<std::thread> handlers;
+        std::mutex mutex;
+        std::vector<uint64_t> received_nonces;
+
+        void accept_loop() {
+            while (!stopping) {
+                int connection = accept(listener, nullptr, nullptr);
+                if (connection < 0) continue;
+                std::lock_guard<std::mutex> lock(mutex);
+                handlers.emplace_back([this, connection] { serve(connection); });
+            }
+        }
+
+        // Sleeps in slices so the server can shut down mid-delay
+        void delay(std::chrono::milliseconds d) {
+            auto until = std::chrono::steady_clock::now() + d;
+            while (!stopping && std::chrono::steady_clock::now() < until) std::this_thread::sleep_for(5ms);
+        }
+
+        void serve(int connection) {
+            std::string request;
+            char buffer[4096];
+            size_t header_end = std::string::npos;
+            while (header_end == std::string::npos) {
+                ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+                if (n <= 0) return (void)close(connection);
+                request.append(buffer, n);
+                header_end = request.find("\r\n\r\n");
+            }
+            size_t body_length = 0;
+            if (size_t at = request.find("Content-Length: "); at != std::string::npos && at < header_end) {
+                body_length = std::stoul(request.substr(at + 16));
+            }
+            while (request.size() < header_end + 4 + body_length) {
+                ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+                if (n <= 0) return (void)close(connection);
+                request.append(buffer, n);
+            }
+
+            std::string target = request.substr(request.find(' ') + 1);
+            target = target.substr(0, target.find(' '));
+            std::string body = request.substr(header_end + 4, body_length);
+            std::string response = respond(target, body).dump();
+
+            std::string reply = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                std::to_string(response.size()) + "\r\nConnection: close\r\n\r\n" + response;
+            send(connection, reply.data(), reply.size(), MSG_NOSIGNAL);
+            close(connection);
+        }
+
+        json respond(const std::string& target, const std::string& body) {
+            std::string path = target.substr(0, target.find('?'));
+            if (path.starts_with("/0/private/")) {
+                if (private_in_call.fetch_add(1) != 0) private_overlaps++;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    received_nonces.push_back(std::stoull(body.substr(6)));  // "nonce=..."
+                }
+                delay(private_delay);
+                private_in_call--;
+                if (path == "/0/private/Balance") return {{"error", json::array()}, {"result", {{"ZUSD", "1234.5600"}}}};
+                return {{"error", json::array()}, {"result", json::object()}};
+            }
+
+            delay(public_delay);
+            if (path == "/0/public/AssetPairs") {
+                return {{"error", json::array()}, {"result", {{"XXBTZUSD", {
+                    {"altname", "XBTUSD"}, {"wsname", "XBT/USD"}, {"base", "XXBT"},
+                    {"pair_decimals", 1}, {"lot_decimals", 8}, {"ordermin", "0.0001"}}}}}};
+            }
+            if (path == "/0/public/Ticker") {
+                std::string ask = std::to_string(ask_ticks / 10) + "." + std::to_string(ask_ticks % 10);
+                json ticker = {{"a", {ask, "1", "1.000"}}, {"b", {ask, "1", "1.000"}}, {"c", {ask, "0.1"}}};
+                std::string pairs = target.substr(target.find("pair=") + 5);
+                json result = json::object();
+                for (size_t start = 0; start <= pairs.size();) {
+                    size_t end = pairs.find("%2C", start);
+                    if (end == std::string::npos) end = pairs.size();
+                    result[pairs.substr(start, end - start)] = ticker;
+                    start = end + 3;
+                }
+                return {{"error", json::array()}, {"result", result}};
+            }
+            return {{"error", json::array()}, {"result", json::object()}};
+        }
+    };
+
+    RateLimitConfig roomy_limits() {
+        RateLimitConfig config;
+        config.api_counter_max = 1000;
+        config.api_decay_per_sec = 1000;
+        config.public_counter_max = 1000;
+        config.public_decay_per_sec = 1000;
+        return config;
+    }
+
+    RequestScheduler::Transport unused_transport() {
+        return [](const std::string&, const json&, bool) -> json { return json::object(); };
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Many slow requests in flight at once on one thread
+    void requests_run_concurrently() {
+        MockExchange exchange;
+        exchange.public_delay = 200ms;
+        RequestScheduler scheduler(unused_transport(), roomy_limits());
+        EventLoop loop(64);
+        AsyncKrakenAPI api(loop, scheduler, true, exchange.url());
+
+        std::vector<Task<json>> tickers;
+        for (int i = 0; i < 50; i++) tickers.push_back(api.get_ticker("PAIR" + std::to_string(i)));
+        auto start = std::chrono::steady_clock::now();
+        auto results = loop.run_until_complete(when_all(loop, std::move(tickers)));
+        CHECK(results.size() == 50);
+        CHECK(seconds_since(start) < 1.0);
+        CHECK(scheduler.get_stats().dispatched == 50);
+        PASS("50 x 200 ms requests in under 1 s on one thread, all admitted");
+    }
+
+    // Public calls wait for the shared public counter
+    void public_calls_are_rate_limited() {
+        MockExchange exchange;
+        RateLimitConfig config;
+        config.public_counter_max = 3;       // 2.7 with headroom
+        config.public_decay_per_sec = 10;
+        RequestScheduler scheduler(unused_transport(), config);
+        EventLoop loop;
+        AsyncKrakenAPI api(loop, scheduler, true, exchange.url());
+
+        std::vector<Task<json>> tickers;
+        for (int i = 0; i < 10; i++) tickers.push_back(api.get_ticker("XBTUSD"));
+        auto start = std::chrono::steady_clock::now();
+        loop.run_until_complete(when_all(loop, std::move(tickers)));
+        // 2 fit the burst, the other 8 come 0.1 s apart
+        CHECK(seconds_since(start) > 0.6);
+        CHECK(scheduler.counter_level(ApiRequest{}) <= 2.7);
+        PASS("10 public calls paced by the public counter");
+    }
+
+    // One private call at a time across both clients, nonces in arrival order
+    void private_calls_are_serialised() {
+        MockExchange exchange;
+        exchange.private_delay = 20ms;
+        setenv("KRAKEN_API_KEY", "test-key", 1);
+        setenv("KRAKEN_API_SECRET", "c2VjcmV0LXNlY3JldC1zZWNyZXQ=", 1);
+
+        // The scheduler's own private lane shares the mock's in-call counter
+        RequestScheduler scheduler([&](const std::string&, const json&, bool) -> json {
+            if (exchange.private_in_call.fetch_add(1) != 0) exchange.private_overlaps++;
+            std::this_thread::sleep_for(20ms);
+            exchange.private_in_call--;
+            return json::object();
+        }, roomy_limits());
+        EventLoop loop;
+        AsyncKrakenAPI api(loop, scheduler, false, exchange.url());
+        CHECK(api.authenticate());
+
+        std::vector<std::shared_future<json>> lane_calls;
+        for (int i = 0; i < 5; i++) {
+            ApiRequest request;
+            request.endpoint = "/0/private/Balance";
+            request.is_private = true;
+            request.priority = RequestPriority::Account;
+            lane_calls.push_back(scheduler.submit(request));
+        }
+        std::vector<Task<Notional>> balances;
+        for (int i = 0; i < 10; i++) balances.push_back(api.get_balance());
+        auto results = loop.run_until_complete(when_all(loop, std::move(balances)));
+        for (auto& call : lane_calls) call.get();
+
+        for (const Notional& balance : results) CHECK(balance == Notional::parse("1234.56"));
+        CHECK(exchange.private_overlaps == 0);
+        std::vector<uint64_t> nonces = exchange.nonces();
+        CHECK(nonces.size() == 10);
+        for (size_t i = 1; i < nonces.size(); i++) CHECK(nonces[i] > nonces[i - 1]);
+        PASS("15 private calls from two clients, none overlapping, nonces increasing");
+    }
+
+    // Paper buys into an open position average the entry
+    void paper_entry_is_averaged() {
+        MockExchange exchange;
+        RequestScheduler scheduler(unused_transport(), roomy_limits());
+        EventLoop loop;
+        AsyncKrakenAPI api(loop, scheduler, true, exchange.url());
+        loop.run_until_complete(api.load_instruments());
+        const InstrumentSpec& spec = api.get_instrument(Symbol("XBTUSD"));
+
+        exchange.ask_ticks = 1000;  // 100.0
+        loop.run_until_complete(api.place_market_order(Symbol("XBTUSD"), Side::Buy, spec.parse_qty("1")));
+        exchange.ask_ticks = 1100;  // 110.0
+        loop.run_until_complete(api.place_market_order(Symbol("XBTUSD"), Side::Buy, spec.parse_qty("3")));
+
+        auto positions = loop.run_until_complete(api.get_open_positions());
+        CHECK(positions.size() == 1);
+        CHECK(positions[0].size == spec.parse_qty("4"));
+        CHECK(positions[0].entry_price == spec.parse_price("107.5"));
+        PASS("paper entry averaged over both buys");
+    }
+
+    // Tasks still suspended after run_until_complete() die with the loop
+    void suspended_tasks_are_destroyed() {
+        MockExchange exchange;
+        setenv("KRAKEN_API_KEY", "test-key", 1);
+        setenv("KRAKEN_API_SECRET", "c2VjcmV0LXNlY3JldC1zZWNyZXQ=", 1);
+        RequestScheduler scheduler(unused_transport(), roomy_limits());
+        static int destroyed = 0;
+        struct Sentinel {
+            ~Sentinel() { destroyed++; }
+        };
+
+        {
+            EventLoop loop;
+            AsyncKrakenAPI api(loop, scheduler, false, exchange.url());
+            CHECK(api.authenticate());
+            exchange.private_delay = 10s;
+            loop.spawn([](EventLoop& l) -> Task<void> {
+                Sentinel sentinel;
+                co_await l.sleep_for(1h);
+            }(loop));
+            loop.spawn([](AsyncKrakenAPI& a) -> Task<void> {
+                Sentinel sentinel;
+                co_await a.get_balance();  // Holds the private lane
+            }(api));
+            loop.run_until_complete([](EventLoop& l) -> Task<void> { co_await l.sleep_for(100ms); }(loop));
+            CHECK(loop.live_tasks() == 2);
+            CHECK(loop.in_flight_requests() == 1);
+        }
+        CHECK(destroyed == 2);
+
+        // The abandoned private call gave the private lane back
+        ApiRequest request;
+        request.endpoint = "/0/private/Balance";
+        request.is_private = true;
+        CHECK(scheduler.admit(request) == 0);
+        scheduler.release(request, json::object());
+        PASS("suspended tasks destroyed with the loop, private lane released");
+    }
+}
+
+int main() {
+    std::signal(SIGPIPE, SIG_IGN);
+    requests_run_concurrently();
+    public_calls_are_rate_limited();
+    private_calls_are_serialised();
+    paper_entry_is_averaged();
+    suspended_tasks_are_destroyed();
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdexcept>
+#include "instrument.hpp"
+#include "test_check.hpp"
+
+/*
+ * The exact-arithmetic core: decimal parse/format, rounding at half-way
+ * values, and InstrumentSpec's cross-scale math.
+ */
+
+namespace {
+    InstrumentSpec spec(int pair_decimals, int lot_decimals, const char* ordermin) {
+        InstrumentSpec s;
+        s.pair = "XXBTZUSD";
+        s.pair_decimals = pair_decimals;
+        s.lot_decimals = lot_decimals;
+        s.ordermin = Qty{fixed_point::parse(ordermin, lot_decimals)};
+        return s;
+    }
+
+    // Surplus digits round to nearest, half away from zero
+    void parse_rounds_surplus_digits() {
+        using fixed_point::parse;
+        CHECK(parse("43251.1", 5) == 4325110000);
+        CHECK(parse("1.234564", 5) == 123456);
+        CHECK(parse("1.234565", 5) == 123457);
+        CHECK(parse("1.2345649", 5) == 123456);  // Only the first surplus digit counts
+        CHECK(parse("-1.234565", 5) == -123457);
+        CHECK(parse("-0.000004", 5) == 0);
+        CHECK(parse("0.999995", 5) == 100000);    // Rounding carries into the whole part
+        CHECK(parse(".5", 1) == 5);
+        CHECK(parse("7", 3) == 7000);
+
+        bool threw = false;
+        try {
+            parse("1.2x", 5);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CHECK(threw);
+        PASS("parse rounds surplus digits, negatives symmetric");
+    }
+
+    void format_round_trips() {
+        using fixed_point::format;
+        using fixed_point::parse;
+        CHECK(format<31>(4325110, 1) == "432511.0");
+        CHECK(format<31>(-5000, 5) == "-0.05000");
+        CHECK(format<31>(7, 0) == "7");
+        for (const char* text : {"0.00000001", "-12.34567890", "92233720.36854775", "100000.00000000"}) {
+            CHECK(format<31>(parse(text, 8), 8) == text);
+        }
+        CHECK(Notional::parse("1234.565").format() == "1234.57");
+        CHECK(Notional::parse("-1234.565").format() == "-1234.57");
+        CHECK(Notional::parse("1234.56").format(4) == "1234.5600");
+        PASS("format round-trips parse");
+    }
+
+    void half_way_values_round_away_from_zero() {
+        using fixed_point::div_round;
+        using fixed_point::rescale;
+        CHECK(div_round(5, 10) == 1);
+        CHECK(div_round(4, 10) == 0);
+        CHECK(div_round(15, 10) == 2);
+        CHECK(div_round(-5, 10) == -1);
+        CHECK(div_round(-4, 10) == 0);
+        CHECK(rescale(125, 2, 1) == 13);
+        CHECK(rescale(-125, 2, 1) == -13);
+        CHECK(rescale(124, 2, 1) == 12);
+        CHECK(rescale(12, 1, 3) == 1200);
+        CHECK(rescale(-12, 3, 3) == -12);
+        PASS("div_round / rescale round half away from zero");
+    }
+
+    // ticks x lots overflows int64 long before the notional does
+    void notional_has_int128_headroom() {
+        InstrumentSpec s = spec(5, 8, "0.0001");
+        Price price = s.parse_price("100000");   // 10^10 ticks
+        Qty qty = s.parse_qty("1000");           // 10^11 lots: product 10^21
+        CHECK(s.notional(price, qty) == Notional::parse("100000000"));
+        CHECK(s.notional(s.parse_price("0.00001"), s.parse_qty("0.00000001")) == Notional{0});  // 10^-13 rounds away
+        CHECK(s.notional(s.parse_price("0.00005"), s.parse_qty("0.1")) == Notional::parse("0.000005"));
+        PASS("notional exact past int64 intermediate range");
+    }
+
+    void qty_for_notional_floors_to_lots() {
+        InstrumentSpec s = spec(1, 8, "0.0001");
+        Price price = s.parse_price("30000.0");
+        Qty qty = s.qty_for_notional(Notional::parse("100"), price);
+        CHECK(qty == s.parse_qty("0.00333333"));   // 0.003333333... floored
+        CHECK(s.notional(price, qty) <= Notional::parse("100"));
+        CHECK(s.notional(price, qty + Qty{1}) > Notional::parse("100"));
+        CHECK(s.meets_minimum(qty));
+
+        Qty dust = s.qty_for_notional(Notional::parse("1"), price);
+        CHECK(dust == s.parse_qty("0.00003333"));
+        CHECK(!s.meets_minimum(dust));             // Below ordermin 0.0001
+
+        CHECK(s.qty_for_notional(Notional::parse("100"), Price{0}).is_zero());
+        CHECK(s.qty_for_notional(Notional::parse("-100"), price).is_zero());
+        PASS("qty_for_notional floors to lots, ordermin rejects dust");
+    }
+}
+
+int main() {
+    parse_rounds_surplus_digits();
+    format_round_trips();
+    half_way_values_round_away_from_zero();
+    notional_has_int128_headroom();
+    qty_for_notional_floors_to_lots();
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <fstream>
+#include <set>
+#include <string>
+#include "order_book.hpp"
+#include "test_check.hpp"
+
+/*
+ * WS v1 / v2 book messages from fixtures/ replayed through OrderBookSet.
+ *
+ * kraken_book_messages.jsonl:
+ * - v1 ETH/XBT: the book from Kraken's v1 checksum guide (published
+ *   checksum 974947235), updates including a republish and a two-payload
+ *   message, one corrupted checksum (line 9), an update while out of sync
+ *   (line 10), then a fresh snapshot
+ * - v2 XBT/USD: the same sequence on the "book" channel (lines 18 and 19)
+ * Their checksums were computed with zlib's CRC32, independently of
+ * OrderBookSet. kraken_book_asset_pairs.json holds the two AssetPairs
+ * entries.
+ */
+
+namespace {
+    const std::string FIXTURES = FIXTURE_DIR;
+
+    struct Replay {
+        InstrumentRegistry instruments;
+        OrderBookSet books{2, 10};
+        std::set<size_t> rejected;  // 1-based line numbers
+        uint32_t first_v1_checksum = 0;
+
+        void track(const std::string& name) {
+            if (books.find(name)) return;
+            if (const InstrumentSpec* spec = instruments.find(name)) books.add_alias(name, books.slot_for(*spec));
+        }
+
+        void run() {
+            CHECK(instruments.load_from_file(FIXTURES + "/kraken_book_asset_pairs.json"));
+            std::ifstream in(FIXTURES + "/kraken_book_messages.jsonl");
+            CHECK(in.good());
+
+            std::string line;
+            for (size_t number = 1; std::getline(in, line); number++) {
+                json message = json::parse(line);
+                if (message.is_array() && message.back().is_string()) {
+                    track(message.back().get<std::string>());
+                } else if (message.is_object() && message.contains("data")) {
+                    for (const auto& entry : message["data"]) track(entry.at("symbol").get<std::string>());
+                }
+                if (!books.apply_ws_message(message)) rejected.insert(number);
+                if (number == 3) first_v1_checksum = books.checksum(*books.find("ETH/XBT"));
+            }
+        }
+    };
+
+    void v1_guide_checksum_matches() {
+        Replay replay;
+        replay.run();
+        CHECK(replay.first_v1_checksum == 974947235u);
+        PASS("v1 snapshot checksum matches Kraken's guide");
+    }
+
+    void failures_are_counted_and_resynced() {
+        Replay replay;
+        replay.run();
+        CHECK((replay.rejected == std::set<size_t>{9, 10, 18, 19}));
+        CHECK(replay.books.checksum_failures() == 2);
+
+        OrderBookSet::BookSlot eth = *replay.books.find("ETH/XBT");
+        OrderBookSet::BookSlot xbt = *replay.books.find("XBT/USD");
+        CHECK(replay.books.in_sync(eth));
+        CHECK(replay.books.in_sync(xbt));
+        CHECK(replay.books.best_ask(eth).ticks == 5005);
+        CHECK(replay.books.best_bid(eth).ticks == 5000);
+        CHECK(replay.books.best_ask(xbt).ticks == 620000);
+        CHECK(replay.books.best_bid(xbt).ticks == 619995);
+        CHECK(replay.books.levels(eth, Side::Sell) == 9);  // 0.05020 removed after the resync
+        PASS("2 checksum failures, 4 rejected messages, both books back in sync");
+    }
+}
+
+int main() {
+    v1_guide_checksum_matches();
+    failures_are_counted_and_resynced();
+    return 0;
+}
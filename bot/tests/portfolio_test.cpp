@@ -0,0 +1,188 @@
+#include <chrono>
+#include "portfolio.hpp"
+#include "test_check.hpp"
+
+/*
+ * PortfolioEngine's running sums and risk gate: pro-rata realization,
+ * flips through zero, shared per-asset buckets, the daily loss breaker
+ * and its UTC reset, the loss-streak cooldown, and reduce-only orders.
+ */
+
+using namespace std::chrono_literals;
+
+namespace {
+    using Slot = PortfolioEngine::PairSlot;
+
+    InstrumentRegistry registry() {
+        InstrumentRegistry instruments;
+        instruments.load_asset_pairs(json::parse(R"({
+            "XXBTZUSD": {"altname": "XBTUSD", "wsname": "XBT/USD", "base": "XXBT",
+                         "pair_decimals": 1, "lot_decimals": 8, "ordermin": "0.0001"},
+            "XXBTZEUR": {"altname": "XBTEUR", "wsname": "XBT/EUR", "base": "XXBT",
+                         "pair_decimals": 1, "lot_decimals": 8, "ordermin": "0.0001"},
+            "XETHZUSD": {"altname": "ETHUSD", "wsname": "ETH/USD", "base": "XETH",
+                         "pair_decimals": 2, "lot_decimals": 8, "ordermin": "0.002"}
+        })"));
+        return instruments;
+    }
+
+    Notional usd(const char* text) { return Notional::parse(text); }
+
+    // Selling part of a position realizes against its share of the cost
+    void partial_reduce_is_pro_rata() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& xbt = instruments.get("XBTUSD");
+        PortfolioEngine portfolio(usd("100000"));
+        Slot slot = portfolio.slot_for(xbt);
+
+        portfolio.on_fill(slot, Side::Buy, xbt.parse_price("50000"), xbt.parse_qty("1"), 1.0);
+        portfolio.on_fill(slot, Side::Buy, xbt.parse_price("52000"), xbt.parse_qty("1"), 1.0);
+        portfolio.on_fill(slot, Side::Sell, xbt.parse_price("53000"), xbt.parse_qty("0.5"), 1.0);
+
+        CHECK(portfolio.realized_pnl() == usd("1000"));       // 26500 - 102000 / 4
+        CHECK(portfolio.unrealized_pnl() == usd("3000"));     // 1.5 x 53000 - 76500
+        CHECK(portfolio.equity() == usd("104000"));
+        CHECK(portfolio.gross_exposure() == usd("79500"));
+        CHECK(portfolio.open_positions() == 1);
+        auto positions = portfolio.positions();
+        CHECK(positions.size() == 1 && positions[0].size == xbt.parse_qty("1.5"));
+
+        portfolio.on_mark(slot, xbt.parse_price("51000"));
+        CHECK(portfolio.unrealized_pnl() == usd("0"));
+        CHECK(portfolio.equity() == usd("101000"));
+        PASS("partial reduce realizes against a pro-rata cost basis");
+    }
+
+    // A fill past flat closes the old side and opens the rest the other way
+    void flip_through_zero() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& eth = instruments.get("ETHUSD");
+        const InstrumentSpec& xbt = instruments.get("XBTUSD");
+        PortfolioEngine portfolio(usd("100000"));
+        Slot eth_slot = portfolio.slot_for(eth);
+        Slot xbt_slot = portfolio.slot_for(xbt);
+
+        portfolio.on_fill(xbt_slot, Side::Buy, xbt.parse_price("50000"), xbt.parse_qty("0.01"), 1.0);
+        portfolio.on_fill(eth_slot, Side::Buy, eth.parse_price("3000"), eth.parse_qty("1"), 1.0);
+        CHECK(portfolio.open_positions() == 2);
+
+        portfolio.on_fill(eth_slot, Side::Sell, eth.parse_price("3100"), eth.parse_qty("3"), 1.0);
+        CHECK(portfolio.realized_pnl() == usd("100"));
+        CHECK(portfolio.open_positions() == 2);                 // Still open, now short
+        CHECK(portfolio.unrealized_pnl() == usd("0"));          // Short 2 entered at the mark
+        CHECK(portfolio.asset_exposure(eth_slot) == usd("6200"));
+
+        portfolio.on_fill(eth_slot, Side::Buy, eth.parse_price("3000"), eth.parse_qty("2"), 1.0);
+        CHECK(portfolio.realized_pnl() == usd("300"));          // + 2 x 100 on the short
+        CHECK(portfolio.open_positions() == 1);
+        CHECK(portfolio.asset_exposure(eth_slot) == usd("0"));
+
+        portfolio.on_fill(xbt_slot, Side::Sell, xbt.parse_price("50000"), xbt.parse_qty("0.01"), 1.0);
+        CHECK(portfolio.open_positions() == 0);
+        CHECK(portfolio.gross_exposure() == usd("0"));
+        CHECK(portfolio.positions().empty());
+        PASS("flip through zero keeps open_count right on both sides");
+    }
+
+    // XBT/USD and XBT/EUR draw on one XBT exposure limit
+    void pairs_share_an_asset_bucket() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& usd_pair = instruments.get("XBTUSD");
+        const InstrumentSpec& eur_pair = instruments.get("XBTEUR");
+        const InstrumentSpec& eth = instruments.get("ETHUSD");
+        PortfolioEngine portfolio(usd("10000"));  // Asset cap 1000
+        Slot xbt_usd = portfolio.slot_for(usd_pair);
+        Slot xbt_eur = portfolio.slot_for(eur_pair);
+        Slot eth_usd = portfolio.slot_for(eth);
+
+        portfolio.on_fill(xbt_usd, Side::Buy, usd_pair.parse_price("50000"), usd_pair.parse_qty("0.01"), 1.0);
+        portfolio.on_fill(xbt_eur, Side::Buy, eur_pair.parse_price("46000"), eur_pair.parse_qty("0.01"), 1.0);
+        CHECK(portfolio.asset_exposure(xbt_usd) == usd("960"));
+        CHECK(portfolio.asset_exposure(xbt_eur) == usd("960"));
+        CHECK(portfolio.asset_exposure(eth_usd) == usd("0"));
+
+        CHECK(portfolio.check(xbt_eur, Side::Buy, eur_pair.parse_price("46000"), eur_pair.parse_qty("0.002"), 1.0) ==
+              RiskVerdict::AssetExposure);
+        CHECK(portfolio.check(xbt_usd, Side::Buy, usd_pair.parse_price("50000"), usd_pair.parse_qty("0.0005"), 2.0) ==
+              RiskVerdict::AssetExposure);  // 25 x 2 leverage
+        CHECK(portfolio.check(eth_usd, Side::Buy, eth.parse_price("3000"), eth.parse_qty("0.3"), 1.0) ==
+              RiskVerdict::Allowed);
+        PASS("XBT/USD and XBT/EUR share one exposure bucket");
+    }
+
+    // Breaker trips on the mark, blocks entries, clears on the next UTC day
+    void daily_loss_halts_until_the_day_rolls() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& xbt = instruments.get("XBTUSD");
+        RiskLimits limits;
+        limits.max_asset_exposure = usd("100000");
+        PortfolioEngine portfolio(usd("10000"), limits);
+        Slot slot = portfolio.slot_for(xbt);
+        auto now = PortfolioEngine::clock::now();
+
+        portfolio.on_fill(slot, Side::Buy, xbt.parse_price("50000"), xbt.parse_qty("0.5"), 1.0);
+        portfolio.on_mark(slot, xbt.parse_price("49002"));  // -499
+        CHECK(!portfolio.halted());
+        portfolio.on_mark(slot, xbt.parse_price("49000"));  // -500
+        CHECK(portfolio.halted());
+        CHECK(portfolio.entry_gate(now) == RiskVerdict::DailyLossLimit);
+        CHECK(portfolio.check(slot, Side::Buy, xbt.parse_price("49000"), xbt.parse_qty("0.01"), 1.0, now) ==
+              RiskVerdict::DailyLossLimit);
+
+        // Reduce-only orders still go through; a sell past flat does not
+        CHECK(portfolio.check(slot, Side::Sell, xbt.parse_price("49000"), xbt.parse_qty("0.5"), 1.0, now) ==
+              RiskVerdict::Allowed);
+        CHECK(portfolio.check(slot, Side::Sell, xbt.parse_price("49000"), xbt.parse_qty("0.6"), 1.0, now) ==
+              RiskVerdict::DailyLossLimit);
+
+        // Recovering intraday does not clear it
+        portfolio.on_mark(slot, xbt.parse_price("50000"));
+        CHECK(portfolio.halted());
+        CHECK(portfolio.max_intraday_drawdown() == usd("500"));
+
+        portfolio.on_mark(slot, xbt.parse_price("49500"));
+        auto tomorrow = now + 24h;
+        CHECK(portfolio.entry_gate(tomorrow) == RiskVerdict::Allowed);
+        CHECK(!portfolio.halted());
+        CHECK(portfolio.daily_pnl() == usd("0"));            // New day starts from current equity
+        CHECK(portfolio.max_intraday_drawdown() == usd("0"));
+        CHECK(portfolio.check(slot, Side::Buy, xbt.parse_price("49500"), xbt.parse_qty("0.01"), 1.0, tomorrow) ==
+              RiskVerdict::Allowed);
+        PASS("daily loss halt, reduce-only allowed, reset on the UTC day roll");
+    }
+
+    void losing_streak_starts_a_cooldown() {
+        InstrumentRegistry instruments = registry();
+        const InstrumentSpec& xbt = instruments.get("XBTUSD");
+        PortfolioEngine portfolio(usd("10000"));  // 3 losses, 300 s
+        Slot slot = portfolio.slot_for(xbt);
+        portfolio.on_fill(slot, Side::Buy, xbt.parse_price("50000"), xbt.parse_qty("0.01"), 1.0);
+        auto now = PortfolioEngine::clock::now();
+
+        portfolio.on_trade_closed(usd("-1"), now);
+        portfolio.on_trade_closed(usd("-1"), now);
+        portfolio.on_trade_closed(usd("2"), now);   // A win resets the streak
+        portfolio.on_trade_closed(usd("-1"), now);
+        portfolio.on_trade_closed(usd("-1"), now);
+        CHECK(portfolio.consecutive_losses() == 2);
+        CHECK(portfolio.entry_gate(now) == RiskVerdict::Allowed);
+
+        portfolio.on_trade_closed(usd("-1"), now);
+        CHECK(portfolio.entry_gate(now + 299s) == RiskVerdict::Cooldown);
+        CHECK(portfolio.check(slot, Side::Buy, xbt.parse_price("50000"), xbt.parse_qty("0.001"), 1.0, now) ==
+              RiskVerdict::Cooldown);
+        CHECK(portfolio.check(slot, Side::Sell, xbt.parse_price("50000"), xbt.parse_qty("0.01"), 1.0, now) ==
+              RiskVerdict::Allowed);  // Reduce-only during the cooldown
+        CHECK(portfolio.entry_gate(now + 300s) == RiskVerdict::Allowed);
+        PASS("cooldown after 3 straight losses, reduce-only still allowed");
+    }
+}
+
+int main() {
+    partial_reduce_is_pro_rata();
+    flip_through_zero();
+    pairs_share_an_asset_bucket();
+    daily_loss_halts_until_the_day_rolls();
+    losing_streak_starts_a_cooldown();
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "request_scheduler.hpp"
+#include "test_check.hpp"
+
+/*
+ * RequestScheduler against a mock exchange that enforces Kraken's decay
+ * counters and throws "EAPI:Rate limit exceeded" like the real one.
+ */
+
+using namespace std::chrono_literals;
+using steady = std::chrono::steady_clock;
+
+namespace {
+    // Exchange-side counter with the real (not headroom-scaled) limit
+    struct MockLimit {
+        double max;
+        double decay_per_sec;
+        double count = 0;
+        steady::time_point last = steady::now();
+
+        bool charge(double cost) {
+            auto now = steady::now();
+            count = std::max(0.0, count - std::chrono::duration<double>(now - last).count() * decay_per_sec);
+            last = now;
+            if (count + cost > max) return false;
+            count += cost;
+            return true;
+        }
+    };
+
+    ApiRequest private_call(const std::string& endpoint, RequestPriority priority = RequestPriority::Account) {
+        ApiRequest request;
+        request.endpoint = endpoint;
+        request.is_private = true;
+        request.priority = priority;
+        return request;
+    }
+
+    // A slow public call must not hold up an order queued behind it
+    void orders_bypass_slow_market_data() {
+        RequestScheduler scheduler([](const std::string& endpoint, const json&, bool) {
+            if (endpoint == "/0/public/Depth") std::this_thread::sleep_for(500ms);
+            return json{{"txid", json::array({"OABC"})}};
+        });
+
+        ApiRequest depth;
+        depth.endpoint = "/0/public/Depth";
+        auto slow = scheduler.submit(depth);
+        std::this_thread::sleep_for(20ms);  // Depth is on the wire
+
+        auto start = steady::now();
+        auto order = private_call("/0/private/AddOrder", RequestPriority::Order);
+        order.pair = "XBTUSD";
+        scheduler.call(order);
+        CHECK(steady::now() - start < 200ms);
+        CHECK(slow.wait_for(0s) != std::future_status::ready);
+        slow.get();
+        PASS("order not blocked by a slow Depth call");
+    }
+
+    // Bursts of private calls never trip the mock exchange's limit
+    void stays_under_the_exchange_limit() {
+        constexpr double SPEED = 50;  // Counters decay 50x faster to keep the test short
+        std::mutex mock_mutex;
+        MockLimit exchange{15, 0.33 * SPEED};
+        std::atomic<int> rejected{0};
+
+        RequestScheduler scheduler([&](const std::string&, const json&, bool) {
+            std::lock_guard<std::mutex> lock(mock_mutex);
+            if (!exchange.charge(1)) {
+                rejected++;
+                throw std::runtime_error("EAPI:Rate limit exceeded");
+            }
+            return json::object();
+        });
+        scheduler.set_time_scale(SPEED);
+
+        std::vector<std::shared_future<json>> calls;
+        for (int i = 0; i < 40; i++) calls.push_back(scheduler.submit(private_call("/0/private/Balance")));
+        for (auto& call : calls) call.get();
+
+        SchedulerStats stats = scheduler.get_stats();
+        CHECK(rejected == 0);
+        CHECK(stats.rate_limit_errors == 0);
+        CHECK(stats.total_wait_seconds > 0);
+        CHECK(stats.total_wait_seconds < 4);
+        PASS("40 private calls, no rate limit errors (" + std::to_string(stats.total_wait_seconds) + "s waited)");
+    }
+
+    // Sharded workers: several schedulers on one key stay under its limit
+    // together when each keeps its share
+    void shared_key_stays_under_the_limit() {
+        constexpr double SPEED = 50;
+        constexpr int PROCESSES = 3;
+        std::mutex mock_mutex;
+        MockLimit exchange{15, 0.33 * SPEED};
+        std::atomic<int> rejected{0};
+        auto transport = [&](const std::string&, const json&, bool) {
+            std::lock_guard<std::mutex> lock(mock_mutex);
+            if (!exchange.charge(1)) {
+                rejected++;
+                throw std::runtime_error("EAPI:Rate limit exceeded");
+            }
+            return json::object();
+        };
+
+        std::vector<std::unique_ptr<RequestScheduler>> workers;
+        for (int k = 0; k < PROCESSES; k++) {
+            workers.push_back(std::make_unique<RequestScheduler>(transport));
+            workers.back()->set_time_scale(SPEED);
+            workers.back()->share_limits(PROCESSES);
+        }
+        std::vector<std::shared_future<json>> calls;
+        for (int i = 0; i < 20; i++) {
+            for (auto& worker : workers) calls.push_back(worker->submit(private_call("/0/private/Balance")));
+        }
+        for (auto& call : calls) call.get();
+
+        CHECK(rejected == 0);
+        PASS(std::to_string(PROCESSES) + " schedulers sharing a key, no rate limit errors");
+    }
+
+    // A cost the counter can never hold fails instead of waiting forever
+    void rejects_impossible_cost() {
+        RequestScheduler scheduler([](const std::string&, const json&, bool) { return json::object(); });
+        auto request = private_call("/0/private/Balance");
+        request.cost = 100;
+        auto future = scheduler.submit(request);
+        CHECK(future.wait_for(1s) == std::future_status::ready);
+        bool threw = false;
+        try {
+            future.get();
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CHECK(threw);
+        PASS("cost above the counter max is rejected");
+    }
+
+    // Ledger queries cost 2; a cancel costs by the age of the order
+    void charges_endpoint_costs() {
+        RequestScheduler scheduler([](const std::string& endpoint, const json&, bool) {
+            if (endpoint == "/0/private/AddOrder") return json{{"txid", json::array({"OYOUNG"})}};
+            return json::object();
+        });
+
+        auto ledgers = private_call("/0/private/Ledgers");
+        double before = scheduler.counter_level(ledgers);
+        scheduler.call(ledgers);
+        CHECK(scheduler.counter_level(ledgers) - before > 1.9);
+
+        auto add = private_call("/0/private/AddOrder", RequestPriority::Order);
+        add.params = {{"pair", "XBTUSD"}};
+        scheduler.call(add);
+
+        ApiRequest pair_counter;
+        pair_counter.priority = RequestPriority::Order;
+        pair_counter.pair = "XBTUSD";
+        double placed = scheduler.counter_level(pair_counter);
+
+        auto cancel = private_call("/0/private/CancelOrder");
+        cancel.params = {{"txid", "OYOUNG"}};
+        scheduler.call(cancel);
+        // Cancelled within 5 s of placement: +8 on the pair's counter
+        CHECK(scheduler.counter_level(pair_counter) - placed > 7.9);
+        PASS("ledger cost 2, young cancel cost 8");
+    }
+}
+
+int main() {
+    orders_bypass_slow_market_data();
+    stays_under_the_exchange_limit();
+    shared_key_stays_under_the_limit();
+    rejects_impossible_cost();
+    charges_endpoint_costs();
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "session_log.hpp"
+#include "test_check.hpp"
+
+/*
+ * Session capture -> replay round trip: exchanges recorded through a mock
+ * transport come back with the same results, order and errors, and a
+ * replay asked for more than was recorded fails loudly.
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct Call {
+        std::string endpoint;
+        json params;
+        bool is_private;
+    };
+
+    // Public and private calls, one of which the exchange rejects
+    const std::vector<Call> SESSION = {
+        {"Time", json::object(), false},
+        {"Ticker", {{"pair", "XBTUSD"}}, false},
+        {"Ticker", {{"pair", "ETHUSD"}}, false},
+        {"Balance", json::object(), true},
+        {"AddOrder", {{"pair", "XBTUSD"}, {"type", "buy"}, {"volume", "5"}}, true},
+        {"OpenOrders", json::object(), true},
+        {"Ticker", {{"pair", "XBTUSD"}}, false},
+    };
+
+    // Answers depend on a call counter, so replay cannot fake them from params
+    RequestScheduler::Transport mock_exchange() {
+        auto served = std::make_shared<int>(0);
+        return [served](const std::string& endpoint, const json& params, bool is_private) -> json {
+            int n = ++*served;
+            if (endpoint == "AddOrder") throw std::runtime_error("EOrder:Insufficient funds");
+            return {{"endpoint", endpoint}, {"params", params}, {"private", is_private}, {"n", n}};
+        };
+    }
+
+    // Result of the call, or the error text prefixed with "!"
+    json outcome(const RequestScheduler::Transport& transport, const Call& call) {
+        try {
+            return transport(call.endpoint, call.params, call.is_private);
+        } catch (const std::exception& e) {
+            return std::string("!") + e.what();
+        }
+    }
+
+    template<typename Exception>
+    bool throws(const std::function<void()>& call) {
+        try {
+            call();
+        } catch (const Exception&) {
+            return true;
+        } catch (...) {
+        }
+        return false;
+    }
+
+    std::vector<json> capture(const fs::path& path) {
+        auto recorder = std::make_shared<SessionRecorder>(path.string());
+        RequestScheduler::Transport transport = recorder->wrap(mock_exchange());
+        std::vector<json> live;
+        for (const Call& call : SESSION) live.push_back(outcome(transport, call));
+        CHECK(recorder->exchanges() == SESSION.size());
+        return live;
+    }
+
+    void replay_matches_capture() {
+        fs::path path = fs::temp_directory_path() / "kraken_session_log_test_replay.bin";
+        std::vector<json> live = capture(path);
+        CHECK(live[4] == "!EOrder:Insufficient funds");
+
+        std::vector<RecordedExchange> log = SessionReplayer::load(path.string());
+        CHECK(log.size() == SESSION.size());
+        for (size_t i = 0; i < log.size(); i++) {
+            CHECK(log[i].endpoint == SESSION[i].endpoint);
+            CHECK(log[i].params == SESSION[i].params);
+            CHECK(log[i].is_private == SESSION[i].is_private);
+            CHECK(log[i].is_error == (i == 4));
+            CHECK(i == 0 || log[i].start_us >= log[i - 1].start_us);
+        }
+
+        auto replayer = std::make_shared<SessionReplayer>(path.string(), 0.0);
+        RequestScheduler::Transport transport = replayer->transport();
+        for (size_t i = 0; i < SESSION.size(); i++) CHECK(outcome(transport, SESSION[i]) == live[i]);
+        CHECK(replayer->remaining() == 0);
+
+        // Recorded errors come back as the exchange's error, not as exhaustion
+        auto again = std::make_shared<SessionReplayer>(path.string(), 0.0);
+        std::string error;
+        try {
+            again->transport()("AddOrder", SESSION[4].params, true);
+        } catch (const ReplayExhausted&) {
+            error = "exhausted";
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        CHECK(error == "EOrder:Insufficient funds");
+        fs::remove(path);
+        PASS("replay returns the captured results, order and errors");
+    }
+
+    // Same-endpoint requests match on params first, then fall back to log order
+    void replay_matches_params_per_endpoint() {
+        fs::path path = fs::temp_directory_path() / "kraken_session_log_test_match.bin";
+        std::vector<json> live = capture(path);
+
+        auto replayer = std::make_shared<SessionReplayer>(path.string(), 0.0);
+        RequestScheduler::Transport transport = replayer->transport();
+        CHECK(outcome(transport, SESSION[2]) == live[2]);   // ETHUSD ahead of the first XBTUSD
+        CHECK(outcome(transport, SESSION[6]) == live[1]);   // First pending XBTUSD
+        CHECK(outcome(transport, {"Ticker", {{"pair", "SOLUSD"}}, false}) == live[6]);
+        fs::remove(path);
+        PASS("requests match recorded params, then recorded order");
+    }
+
+    void extra_calls_exhaust_the_replay() {
+        fs::path path = fs::temp_directory_path() / "kraken_session_log_test_extra.bin";
+        capture(path);
+
+        auto replayer = std::make_shared<SessionReplayer>(path.string(), 0.0);
+        RequestScheduler::Transport transport = replayer->transport();
+        for (const Call& call : SESSION) outcome(transport, call);
+
+        CHECK(throws<ReplayExhausted>([&] { transport("Ticker", {{"pair", "XBTUSD"}}, false); }));
+        CHECK(throws<ReplayExhausted>([&] { transport("Time", json::object(), false); }));
+        CHECK(throws<ReplayExhausted>([&] { transport("CancelOrder", {{"txid", "O1"}}, true); }));
+
+        // A divergent endpoint is caught before the log runs out
+        auto early = std::make_shared<SessionReplayer>(path.string(), 0.0);
+        CHECK(throws<ReplayExhausted>([&] { early->transport()("Ledgers", json::object(), true); }));
+        CHECK(early->remaining() == SESSION.size());
+        fs::remove(path);
+        PASS("extra or divergent calls throw ReplayExhausted");
+    }
+}
+
+int main() {
+    replay_matches_capture();
+    replay_matches_params_per_endpoint();
+    extra_calls_exhaust_the_replay();
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shard.hpp"
+#include "test_check.hpp"
+
+/*
+ * Workers sharing one API key: private calls through serialize_private
+ * never overlap across processes, and a lock left by a dead worker is
+ * taken over.
+ */
+
+using namespace std::chrono_literals;
+
+namespace {
+    const std::string SEGMENT = "/kraken_bot_shard_test";
+
+    // Counters the forked workers and the test share
+    struct Shared {
+        int in_call = 0;
+        int overlaps = 0;
+        int calls = 0;
+    };
+
+    Shared* shared_counters() {
+        void* memory = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        CHECK(memory != MAP_FAILED);
+        return new (memory) Shared{};
+    }
+
+    // Private calls from every worker run one at a time
+    void private_calls_never_overlap() {
+        constexpr uint32_t WORKERS = 3;
+        constexpr int CALLS = 100;
+        ShardCoordinator coordinator(SEGMENT, WORKERS, Notional::from_double(10000), RiskLimits{});
+        Shared* shared = shared_counters();
+
+        std::vector<pid_t> children;
+        for (uint32_t k = 0; k < WORKERS; k++) {
+            pid_t pid = fork();
+            CHECK(pid >= 0);
+            if (pid == 0) {
+                ShardLink link(SEGMENT, k);
+                auto transport = link.serialize_private([shared](const std::string&, const json&, bool) {
+                    std::atomic_ref<int> in_call(shared->in_call);
+                    if (in_call.fetch_add(1) != 0) std::atomic_ref<int>(shared->overlaps)++;
+                    std::this_thread::sleep_for(50us);
+                    in_call.fetch_sub(1);
+                    std::atomic_ref<int>(shared->calls)++;
+                    return json::object();
+                });
+                for (int i = 0; i < CALLS; i++) transport("/0/private/Balance", json::object(), true);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        CHECK(shared->calls == static_cast<int>(WORKERS) * CALLS);
+        CHECK(shared->overlaps == 0);
+        munmap(shared, sizeof(Shared));
+        PASS("300 private calls from 3 workers, none overlapping");
+    }
+
+    // A worker that dies mid-call does not block the others forever
+    void dead_holder_is_taken_over() {
+        ShardCoordinator coordinator(SEGMENT, 2, Notional::from_double(10000), RiskLimits{});
+
+        pid_t pid = fork();
+        CHECK(pid >= 0);
+        if (pid == 0) {
+            ShardLink link(SEGMENT, 0);
+            auto transport = link.serialize_private([](const std::string&, const json&, bool) -> json { _exit(0); });
+            transport("/0/private/AddOrder", json::object(), true);
+            _exit(1);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+        ShardLink link(SEGMENT, 1);
+        auto transport = link.serialize_private([](const std::string&, const json&, bool) {
+            return json{{"ok", true}};
+        });
+        auto start = std::chrono::steady_clock::now();
+        CHECK(transport("/0/private/Balance", json::object(), true).value("ok", false));
+        CHECK(std::chrono::steady_clock::now() - start < 1s);
+        PASS("lock held by a dead worker is taken over");
+    }
+
+    void rejects_out_of_range_worker() {
+        ShardCoordinator coordinator(SEGMENT, 2, Notional::from_double(10000), RiskLimits{});
+        bool threw = false;
+        try {
+            ShardLink link(SEGMENT, 2);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+        PASS("worker index past the shard count is rejected");
+    }
+}
+
+int main() {
+    private_calls_never_overlap();
+    dead_holder_is_taken_over();
+    rejects_out_of_range_worker();
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iostream>
+#include <cstdlib>
+
+/*
+ * Minimal checks for the test executables: CHECK stays active in
+ * optimised builds (unlike assert) and aborts the test with the failed
+ * expression and its location.
+ */
+
+#define CHECK(expr)                                                                  \
+    do {                                                                             \
+        if (!(expr)) {                                                               \
+            std::cerr << "❌ " << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ")" \
+                      << std::endl;                                                  \
+            std::exit(1);                                                            \
+        }                                                                            \
+    } while (0)
+
+#define PASS(name) std::cout << "✅ " << name << std::endl
@@ -0,0 +1,111 @@
+#include <filesystem>
+#include <string>
+#include "tick_store.hpp"
+#include "test_check.hpp"
+
+/*
+ * TickRecorder round trip: time-capped blocks, no descriptors held between
+ * blocks, footers on close, and write failures reported instead of thrown.
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int64_t DAY_US = 1'760'000'000'000'000;  // 2025-10-09 UTC, mid-day
+    constexpr int64_t SECOND_US = 1'000'000;
+
+    InstrumentSpec spec_for(const std::string& pair) {
+        InstrumentSpec spec;
+        spec.pair = pair;
+        spec.pair_decimals = 1;
+        spec.lot_decimals = 8;
+        return spec;
+    }
+
+    size_t open_descriptors() {
+        size_t count = 0;
+        for ([[maybe_unused]] const auto& entry : fs::directory_iterator("/proc/self/fd")) count++;
+        return count;
+    }
+
+    fs::path scratch(const char* name) {
+        fs::path dir = fs::temp_directory_path() / name;
+        fs::remove_all(dir);
+        return dir;
+    }
+
+    // A quiet pair's block is written once it spans block_span, not at 4096 rows
+    void blocks_are_time_capped() {
+        fs::path dir = scratch("kraken_tick_store_test_span");
+        InstrumentSpec spec = spec_for("XBTUSD");
+        {
+            TickRecorder recorder(dir.string(), 4096, std::chrono::seconds(60));
+            for (int i = 0; i < 10; i++) {
+                recorder.record(spec, Tick{DAY_US + i * 30 * SECOND_US, TickKind::Last, Price{500000 + i}, Qty{100}});
+            }
+            recorder.flush_due(DAY_US + (9 * 30 + 60) * SECOND_US);  // Last row is now 60 s old
+
+            // Readable while the recorder is still open (no footer yet)
+            TickHistory history(dir.string());
+            uint64_t rows = history.scan(spec.pair, DAY_US, DAY_US + 3600 * SECOND_US, [](const TickBatch&) {});
+            CHECK(rows == 10);
+        }
+
+        auto segments = TickHistory(dir.string()).segments(spec.pair, DAY_US, DAY_US + SECOND_US);
+        CHECK(segments.size() == 1);
+        SegmentReader reader(segments[0]);
+        CHECK(reader.row_count() == 10);
+        CHECK(reader.block_count() >= 4);  // 30 s apart, 60 s blocks
+        fs::remove_all(dir);
+        PASS("blocks capped at 60 s, all rows readable before and after close");
+    }
+
+    // Hundreds of pairs do not pin hundreds of descriptors
+    void no_descriptor_per_pair() {
+        fs::path dir = scratch("kraken_tick_store_test_fds");
+        size_t before = open_descriptors();
+        {
+            TickRecorder recorder(dir.string(), 4, std::chrono::seconds(60));
+            for (int p = 0; p < 300; p++) {
+                InstrumentSpec spec = spec_for("PAIR" + std::to_string(p));
+                for (int i = 0; i < 10; i++) {
+                    recorder.record(spec, Tick{DAY_US + i, TickKind::Bid, Price{100 + i}, Qty{1}});
+                }
+            }
+            CHECK(open_descriptors() == before);
+            CHECK(recorder.write_errors() == 0);
+        }
+        SegmentReader reader(TickHistory(dir.string()).segments(Symbol("PAIR7"), DAY_US, DAY_US + 1)[0]);
+        CHECK(reader.row_count() == 10);
+        fs::remove_all(dir);
+        PASS("300 pairs recorded with no descriptors held");
+    }
+
+    // A failing write is counted and reported; recording carries on
+    void write_failures_are_reported() {
+        fs::path dir = scratch("kraken_tick_store_test_errors");
+        InstrumentSpec spec = spec_for("ETHUSD");
+        TickRecorder recorder(dir.string(), 2, std::chrono::seconds(60));
+        recorder.record(spec, Tick{DAY_US, TickKind::Last, Price{30000}, Qty{1}});
+        fs::remove_all(dir);  // The next block's open fails
+
+        recorder.record(spec, Tick{DAY_US + 1, TickKind::Last, Price{30001}, Qty{1}});
+        CHECK(recorder.write_errors() >= 1);
+
+        fs::create_directories(dir);
+        uint64_t errors = recorder.write_errors();
+        recorder.record(spec, Tick{DAY_US + 2, TickKind::Last, Price{30002}, Qty{1}});
+        recorder.flush();
+        CHECK(recorder.write_errors() == errors);
+        recorder.close();
+        fs::remove_all(dir);
+        PASS("write failure reported, recording resumes");
+    }
+}
+
+int main() {
+    blocks_are_time_capped();
+    no_descriptor_per_pair();
+    write_failures_are_reported();
+    return 0;
+}
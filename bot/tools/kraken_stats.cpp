@@ -0,0 +1,52 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <cctype>
+#include "stats_shm.hpp"
+
+/*
+ * Print the running bot's live stats segment as JSON.
+ *
+ *   kraken_stats                 one snapshot
+ *   kraken_stats --watch [ms]    poll forever (default every 500 ms)
+ *   kraken_stats --segment NAME  non-default segment name
+ */
+
+int main(int argc, char* argv[]) {
+    std::string segment = "/kraken_bot_stats";
+    bool watch = false;
+    int interval_ms = 500;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--watch") {
+            watch = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                interval_ms = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--segment" && i + 1 < argc) {
+            segment = argv[++i];
+        } else if (arg == "--help") {
+            std::cout << "Usage: kraken_stats [--watch [ms]] [--segment NAME]" << std::endl;
+            return 0;
+        }
+    }
+
+    try {
+        StatsReader reader(segment);
+        StatsSegment snapshot;
+        do {
+            if (!reader.read(snapshot)) {
+                std::cerr << "⚠️  Writer busy, no consistent snapshot" << std::endl;
+            } else {
+                std::cout << StatsReader::to_json(snapshot).dump(watch ? -1 : 2) << std::endl;
+            }
+            if (watch) std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        } while (watch);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -27,6 +27,17 @@ const MIME_TYPES = {
 const POLYMARKET_CLOB = 'https://clob.polymarket.com';
 const POLYMARKET_GAMMA = 'https://gamma-api.polymarket.com';
 
+// Live stats published by the C++ bot (bot/include/stats_shm.hpp)
+const BOT_STATS_PATH = process.env.BOT_STATS_PATH || '/dev/shm/kraken_bot_stats';
+const BOT_STATS = {
+    MAGIC: 0x5453424B,
+    VERSION: 1,
+    SIZE: 7392,
+    POSITIONS: { offset: 104, count: 16, size: 80 },
+    PATTERNS: { offset: 1384, count: 64, size: 80 },
+    LATENCY: { offset: 6504, count: 3, size: 296, buckets: 32 }
+};
+
 /**
  * Make HTTPS request and return promise
  */
@@ -66,6 +77,110 @@ function httpsGet(targetUrl) {
     });
 }
 
+/**
+ * Read a consistent snapshot of the bot's stats segment (seqlock: retry
+ * while the sequence is odd or changed during the copy)
+ */
+function readBotStats() {
+    const fd = fs.openSync(BOT_STATS_PATH, 'r');
+    try {
+        const buf = Buffer.alloc(BOT_STATS.SIZE);
+        const seq = Buffer.alloc(8);
+        for (let attempt = 0; attempt < 1000; attempt++) {
+            fs.readSync(fd, buf, 0, BOT_STATS.SIZE, 0);
+            const before = buf.readBigUInt64LE(8);
+            if (before & 1n) continue;
+            fs.readSync(fd, seq, 0, 8, 8);
+            if (seq.readBigUInt64LE(0) === before) return decodeBotStats(buf);
+        }
+        throw new Error('Bot stats writer busy');
+    } finally {
+        fs.closeSync(fd);
+    }
+}
+
+function decodeBotStats(buf) {
+    const text = (offset, len) => {
+        const raw = buf.subarray(offset, offset + len);
+        const end = raw.indexOf(0);
+        return raw.toString('utf8', 0, end < 0 ? len : end);
+    };
+    const fixed = (raw, decimals) => Number(raw) / 10 ** decimals;
+    const usd = raw => Number(raw) / 1e8;
+
+    if (buf.readUInt32LE(0) !== BOT_STATS.MAGIC || buf.readUInt32LE(4) !== BOT_STATS.VERSION ||
+        buf.readUInt32LE(16) !== BOT_STATS.SIZE) {
+        throw new Error('Unknown bot stats layout');
+    }
+
+    const trades = Number(buf.readBigUInt64LE(40));
+    const wins = Number(buf.readBigUInt64LE(48));
+    const stats = {
+        pid: buf.readUInt32LE(20),
+        startedUs: Number(buf.readBigInt64LE(24)),
+        updatedUs: Number(buf.readBigInt64LE(32)),
+        trades,
+        wins,
+        winRate: trades ? wins / trades : 0,
+        sessionPnl: usd(buf.readBigInt64LE(56)),
+        maxDrawdown: usd(buf.readBigInt64LE(72)),
+        regime: text(80, 16),
+        positions: [],
+        patterns: [],
+        latency: {}
+    };
+
+    const P = BOT_STATS.POSITIONS;
+    for (let i = 0; i < P.count; i++) {
+        const o = P.offset + i * P.size;
+        if (buf[o] === 0) continue;
+        const pairDecimals = buf.readInt32LE(o + 64);
+        const lotDecimals = buf.readInt32LE(o + 68);
+        stats.positions.push({
+            pair: text(o, 24),
+            size: fixed(buf.readBigInt64LE(o + 24), lotDecimals),
+            entry: fixed(buf.readBigInt64LE(o + 32), pairDecimals),
+            mark: fixed(buf.readBigInt64LE(o + 40), pairDecimals),
+            unrealizedPnl: usd(buf.readBigInt64LE(o + 48)),
+            leverage: buf.readDoubleLE(o + 56),
+            openedUs: Number(buf.readBigInt64LE(o + 72))
+        });
+    }
+
+    const T = BOT_STATS.PATTERNS;
+    const patternCount = Math.min(buf.readUInt32LE(100), T.count);
+    for (let i = 0; i < patternCount; i++) {
+        const o = T.offset + i * T.size;
+        const n = buf.readUInt32LE(o + 32);
+        const mean = n ? buf.readDoubleLE(o + 48) / n : 0;
+        const variance = n ? Math.max(0, buf.readDoubleLE(o + 56) / n - mean * mean) : 0;
+        stats.patterns.push({
+            key: text(o, 32),
+            trades: n,
+            winRate: n ? buf.readUInt32LE(o + 36) / n : 0,
+            pnl: usd(buf.readBigInt64LE(o + 40)),
+            avgRoi: mean,
+            sharpe: n >= 2 && variance > 0 ? mean / Math.sqrt(variance) : 0
+        });
+    }
+
+    const L = BOT_STATS.LATENCY;
+    for (let k = 0; k < L.count; k++) {
+        const o = L.offset + k * L.size;
+        const count = Number(buf.readBigUInt64LE(o + 16));
+        const maxNs = Number(buf.readBigUInt64LE(o + 32));
+        const buckets = [];
+        for (let b = 0; b < L.buckets; b++) buckets.push(Number(buf.readBigUInt64LE(o + 40 + b * 8)));
+        stats.latency[text(o, 16)] = {
+            count,
+            meanUs: count ? Number(buf.readBigUInt64LE(o + 24)) / 1000 / count : 0,
+            maxUs: maxNs / 1000,
+            buckets   // buckets[i] = samples in [2^i, 2^(i+1)) ns
+        };
+    }
+    return stats;
+}
+
 /**
  * Serve static files
  */
@@ -187,6 +302,23 @@ const server = http.createServer(async (req, res) => {
             return;
         }
 
+        // Live C++ bot stats (shared memory, no bot round trip)
+        if (apiPath === 'bot-stats') {
+            try {
+                const stats = readBotStats();
+                res.writeHead(200, {
+                    'Content-Type': 'application/json',
+                    'Access-Control-Allow-Origin': '*'
+                });
+                res.end(JSON.stringify(stats));
+            } catch (error) {
+                const status = error.code === 'ENOENT' ? 503 : 500;
+                res.writeHead(status, { 'Content-Type': 'application/json' });
+                res.end(JSON.stringify({ error: error.code === 'ENOENT' ? 'Bot not running' : error.message }));
+            }
+            return;
+        }
+
         // Unknown API route
         res.writeHead(404, { 'Content-Type': 'application/json' });
         res.end(JSON.stringify({ error: 'Unknown API endpoint' }));
@@ -219,6 +351,7 @@ server.listen(PORT, () => {
 ║    /api/book/{tokenId}   - Get orderbook                   ║
 ║    /api/price/{tokenId}  - Get current price               ║
 ║    /api/gamma/{path}     - Proxy to Gamma API              ║
+║    /api/bot-stats        - Live C++ bot stats (shm)        ║
 ╠════════════════════════════════════════════════════════════╣
 ║  Real-time prices via server proxy (no CORS issues)        ║
 ╚════════════════════════════════════════════════════════════╝